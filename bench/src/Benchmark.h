@@ -0,0 +1,83 @@
+#ifndef CG_SOLAR_SYSTEM_BENCHMARK_H
+#define CG_SOLAR_SYSTEM_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+    // Written with the result of every benchmark so the compiler can't drop the measured work
+    inline volatile float sink = 0;
+
+    // Calls body repeatedly, doubling the number of calls until a run takes at least min_time, and returns the
+    // nanoseconds per operation of that run. body does ops_per_call operations per call.
+    template <typename Body>
+    double MeasureNsPerOp(
+        const size_t ops_per_call,
+        Body &&body,
+        const std::chrono::nanoseconds min_time = std::chrono::milliseconds(200)
+    )
+    {
+        using Clock = std::chrono::steady_clock;
+
+        body(); // warm up caches and branch predictors
+        for (size_t calls = 1;; calls *= 2)
+        {
+            const auto start = Clock::now();
+            for (size_t i = 0; i < calls; ++i)
+            {
+                body();
+            }
+            const auto elapsed = Clock::now() - start;
+
+            if (elapsed >= min_time)
+            {
+                const auto nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count();
+                return nanoseconds / static_cast<double>(calls * ops_per_call);
+            }
+        }
+    }
+
+    // A benchmark over size elements. run does size operations and output returns its results, which are compared
+    // against the scalar instruction set. Benchmarks that don't go through the SIMD dispatch run only once.
+    struct Benchmark
+    {
+        std::string name;
+        size_t size;
+        bool dispatched;
+        std::function<void()> run;
+        std::function<std::vector<float>()> output;
+        // Extra measurements for the active instruction set, reported next to the timing
+        std::function<std::vector<std::pair<std::string, double>>()> metrics = {};
+    };
+
+    struct Result
+    {
+        std::string name;
+        std::string isa;
+        size_t size;
+        double ns_per_op;
+        double max_error; // largest absolute difference against the scalar results
+        std::vector<std::pair<std::string, double>> metrics;
+    };
+
+    // One JSON object per line, so results can be appended to a file and compared across versions
+    inline void PrintJson(const Result &result)
+    {
+        std::cout << R"({"name":")" << result.name << R"(","isa":")" << result.isa << R"(","size":)" << result.size
+                  << R"(,"ns_per_op":)" << result.ns_per_op << R"(,"ops_per_second":)" << 1e9 / result.ns_per_op
+                  << R"(,"max_error":)" << result.max_error;
+        for (const auto &[key, value] : result.metrics)
+        {
+            std::cout << R"(,")" << key << R"(":)" << value;
+        }
+        std::cout << "}" << std::endl;
+    }
+} // namespace bench
+
+#endif // CG_SOLAR_SYSTEM_BENCHMARK_H
@@ -0,0 +1,782 @@
+#include "MathBenchmarks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <span>
+
+#include "Frustum.h"
+#include "Kepler.h"
+#include "Mat.h"
+#include "SinCos.h"
+#include "Spline.h"
+#include "SplineBatch.h"
+#include "World.h"
+
+namespace
+{
+    std::mt19937 random_engine(42);
+
+    float randomFloat(const float min, const float max)
+    {
+        return std::uniform_real_distribution<float>(min, max)(random_engine);
+    }
+
+    Vec3f randomVec3f(const float range)
+    {
+        return {randomFloat(-range, range), randomFloat(-range, range), randomFloat(-range, range)};
+    }
+
+    Mat4f randomMat4f()
+    {
+        Mat4f result;
+        for (auto &row : result.mat)
+            for (auto &value : row)
+                value = randomFloat(-2, 2);
+        return result;
+    }
+
+    // Translation * rotation * scale, like the groups of the scenes
+    Mat3x4f randomTransform()
+    {
+        const Vec3f axis = randomVec3f(1).Normalize();
+        const Vec3f translation = randomVec3f(100);
+        return Mat3x4fTranslate(translation.x, translation.y, translation.z) *
+            Mat3x4fRotate(randomFloat(-M_PI, M_PI), axis.x, axis.y, axis.z) *
+            Mat3x4fScale(randomFloat(0.1f, 2), randomFloat(0.1f, 2), randomFloat(0.1f, 2));
+    }
+
+    // Every math type is made of floats only
+    template <typename T>
+    std::vector<float> toFloats(const std::vector<T> &values)
+    {
+        std::vector<float> result(values.size() * sizeof(T) / sizeof(float));
+        std::memcpy(result.data(), values.data(), values.size() * sizeof(T));
+        return result;
+    }
+
+    template <typename State>
+    bench::Benchmark createBenchmark(
+        std::string name,
+        const size_t size,
+        const bool dispatched,
+        std::shared_ptr<State> state,
+        void (*run)(State &),
+        std::vector<float> (*output)(State &)
+    )
+    {
+        return {
+            std::move(name),
+            size,
+            dispatched,
+            [state, run] { run(*state); },
+            [state, output] { return output(*state); },
+        };
+    }
+
+    // Same as the scene path of a planet: points in a circle
+    std::vector<Vec3f> circlePath(const size_t number_of_points, const float distance)
+    {
+        std::vector<Vec3f> points;
+        for (size_t i = 0; i < number_of_points; ++i)
+        {
+            points.push_back(Vec3fPolar(distance, i * M_PI * 2 / number_of_points, randomFloat(-1, 1)));
+        }
+        return points;
+    }
+
+    template <typename A, typename B, typename Out>
+    struct BinaryState
+    {
+        std::vector<A> a;
+        std::vector<B> b;
+        std::vector<Out> out;
+
+        explicit BinaryState(const size_t size) : a(size), b(size), out(size) {}
+    };
+
+    bench::Benchmark mat4fMultiply(const size_t size)
+    {
+        using State = BinaryState<Mat4f, Mat4f, Mat4f>;
+        auto state = std::make_shared<State>(size);
+        std::ranges::generate(state->a, randomMat4f);
+        std::ranges::generate(state->b, randomMat4f);
+
+        return createBenchmark<State>(
+            "mat4f_multiply",
+            size,
+            true,
+            state,
+            [](State &s)
+            {
+                for (size_t i = 0; i < s.out.size(); ++i)
+                    s.out[i] = s.a[i] * s.b[i];
+                bench::sink = s.out.back().mat[0][0];
+            },
+            [](State &s) { return toFloats(s.out); }
+        );
+    }
+
+    bench::Benchmark mat4fVecMultiply(const size_t size)
+    {
+        using State = BinaryState<Mat4f, Vec4f, Vec4f>;
+        auto state = std::make_shared<State>(size);
+        std::ranges::generate(state->a, randomMat4f);
+        std::ranges::generate(state->b, [] { return randomVec3f(10).ToVec4f(); });
+
+        return createBenchmark<State>(
+            "mat4f_vec_multiply",
+            size,
+            true,
+            state,
+            [](State &s)
+            {
+                for (size_t i = 0; i < s.out.size(); ++i)
+                    s.out[i] = s.a[i] * s.b[i];
+                bench::sink = s.out.back().x;
+            },
+            [](State &s) { return toFloats(s.out); }
+        );
+    }
+
+    bench::Benchmark mat3x4fMultiply(const size_t size)
+    {
+        using State = BinaryState<Mat3x4f, Mat3x4f, Mat3x4f>;
+        auto state = std::make_shared<State>(size);
+        std::ranges::generate(state->a, randomTransform);
+        std::ranges::generate(state->b, randomTransform);
+
+        return createBenchmark<State>(
+            "mat3x4f_multiply",
+            size,
+            true,
+            state,
+            [](State &s)
+            {
+                for (size_t i = 0; i < s.out.size(); ++i)
+                    s.out[i] = s.a[i] * s.b[i];
+                bench::sink = s.out.back().cols[3][0];
+            },
+            [](State &s) { return toFloats(s.out); }
+        );
+    }
+
+    bench::Benchmark transformPoints(const size_t size)
+    {
+        struct State
+        {
+            Mat3x4f matrix = randomTransform();
+            std::vector<Vec3f> points, out;
+        };
+        auto state = std::make_shared<State>();
+        state->points.resize(size);
+        state->out.resize(size);
+        std::ranges::generate(state->points, [] { return randomVec3f(10); });
+
+        return createBenchmark<State>(
+            "transform_points",
+            size,
+            true,
+            state,
+            [](State &s)
+            {
+                TransformPoints(s.matrix, s.points, s.out);
+                bench::sink = s.out.back().x;
+            },
+            [](State &s) { return toFloats(s.out); }
+        );
+    }
+
+    bench::Benchmark vec3fNormalizeCross(const size_t size)
+    {
+        using State = BinaryState<Vec3f, Vec3f, Vec3f>;
+        auto state = std::make_shared<State>(size);
+        std::ranges::generate(state->a, [] { return randomVec3f(10); });
+        std::ranges::generate(state->b, [] { return randomVec3f(10); });
+
+        return createBenchmark<State>(
+            "vec3f_normalize_cross",
+            size,
+            false,
+            state,
+            [](State &s)
+            {
+                for (size_t i = 0; i < s.out.size(); ++i)
+                    s.out[i] = s.a[i].Cross(s.b[i]).Normalize();
+                bench::sink = s.out.back().x;
+            },
+            [](State &s) { return toFloats(s.out); }
+        );
+    }
+
+    // Same as the scene path of the comet: points at even angles of an ellipse, unevenly spaced along it
+    std::vector<Vec3f> ellipsePath(const size_t number_of_points, const float distance_a, const float distance_b)
+    {
+        std::vector<Vec3f> points;
+        for (size_t i = 0; i < number_of_points; ++i)
+        {
+            points.push_back(Vec3fElipse(distance_a, distance_b, i * M_PI * 2 / number_of_points, 0));
+        }
+        return points;
+    }
+
+    // Fastest over slowest distance travelled in evenly spaced time steps around the loop, 1 at constant speed
+    double speedRatio(const CatmullRomSpline &spline)
+    {
+        constexpr size_t steps = 1000;
+        Vec3f previous, derivative;
+        spline.Evaluate(0, previous, derivative);
+
+        double slowest = INFINITY, fastest = 0;
+        for (size_t i = 1; i <= steps; ++i)
+        {
+            Vec3f position;
+            spline.Evaluate(static_cast<float>(i) / steps, position, derivative);
+            const double distance = (position - previous).Length();
+            slowest = std::min(slowest, distance);
+            fastest = std::max(fastest, distance);
+            previous = position;
+        }
+        return fastest / slowest;
+    }
+
+    struct CatmullRomState
+    {
+        std::vector<Vec3f> points;
+        CatmullRomSpline spline;
+        std::vector<float> times;
+        std::vector<Vec3f> positions, derivatives;
+
+        explicit CatmullRomState(
+            const size_t size,
+            std::vector<Vec3f> path = circlePath(10, 50),
+            const bool constant_speed = false
+        ) :
+            points(std::move(path)), spline(points, constant_speed), times(size), positions(size), derivatives(size)
+        {
+            std::ranges::generate(times, [] { return randomFloat(0, 1); });
+        }
+
+        std::vector<float> output() const
+        {
+            auto result = toFloats(positions);
+            const auto derivative_floats = toFloats(derivatives);
+            result.insert(result.end(), derivative_floats.begin(), derivative_floats.end());
+            return result;
+        }
+    };
+
+    // Building the segment every evaluation, like before the spline cache
+    bench::Benchmark catmullRom(const size_t size)
+    {
+        return createBenchmark<CatmullRomState>(
+            "catmull_rom",
+            size,
+            false,
+            std::make_shared<CatmullRomState>(size),
+            [](CatmullRomState &s)
+            {
+                for (size_t i = 0; i < s.times.size(); ++i)
+                    getCatmullRomPoint(s.times[i], s.points, s.positions[i], s.derivatives[i]);
+                bench::sink = s.positions.back().x;
+            },
+            [](CatmullRomState &s) { return s.output(); }
+        );
+    }
+
+    bench::Benchmark catmullRomCached(const size_t size)
+    {
+        return createBenchmark<CatmullRomState>(
+            "catmull_rom_cached",
+            size,
+            false,
+            std::make_shared<CatmullRomState>(size),
+            [](CatmullRomState &s)
+            {
+                for (size_t i = 0; i < s.times.size(); ++i)
+                    s.spline.Evaluate(s.times[i], s.positions[i], s.derivatives[i]);
+                bench::sink = s.positions.back().x;
+            },
+            [](CatmullRomState &s) { return s.output(); }
+        );
+    }
+
+    // Arc length table lookup on top of the cached segments, on a path where the plain spline changes speed
+    bench::Benchmark catmullRomConstantSpeed(const size_t size)
+    {
+        const auto state = std::make_shared<CatmullRomState>(size, ellipsePath(10, 30, 50), true);
+        auto benchmark = createBenchmark<CatmullRomState>(
+            "catmull_rom_constant_speed",
+            size,
+            false,
+            state,
+            [](CatmullRomState &s)
+            {
+                for (size_t i = 0; i < s.times.size(); ++i)
+                    s.spline.Evaluate(s.times[i], s.positions[i], s.derivatives[i]);
+                bench::sink = s.positions.back().x;
+            },
+            [](CatmullRomState &s) { return s.output(); }
+        );
+        benchmark.metrics = [state]() -> std::vector<std::pair<std::string, double>>
+        {
+            return {
+                {"speed_ratio", speedRatio(state->spline)},
+                {"uniform_speed_ratio", speedRatio(CatmullRomSpline(state->points))},
+            };
+        };
+        return benchmark;
+    }
+
+    // Planet and moon orbits of the generator, closed form against the 10 point Catmull-Rom loop they replace
+    bench::Benchmark keplerOrbit(const size_t size)
+    {
+        struct State
+        {
+            std::vector<world::transform::KeplerOrbit> orbits;
+            std::vector<float> times;
+            std::vector<Vec3f> positions;
+        };
+        auto state = std::make_shared<State>();
+        for (size_t i = 0; i < size; ++i)
+        {
+            state->orbits.emplace_back(
+                randomFloat(5, 40), randomFloat(10, 100), randomFloat(0, 0.25f), randomFloat(0, 0.1f),
+                randomFloat(0, M_PI * 2), randomFloat(0, M_PI * 2), randomFloat(0, M_PI * 2)
+            );
+            state->times.push_back(randomFloat(0, 1000));
+        }
+        state->positions.resize(size);
+
+        auto benchmark = createBenchmark<State>(
+            "kepler_orbit",
+            size,
+            false,
+            state,
+            [](State &s)
+            {
+                for (size_t i = 0; i < s.orbits.size(); ++i)
+                    s.positions[i] = s.orbits[i].GetPosition(s.times[i]);
+                bench::sink = s.positions.back().x;
+            },
+            [](State &s) { return toFloats(s.positions); }
+        );
+        benchmark.metrics = []() -> std::vector<std::pair<std::string, double>>
+        {
+            // Largest error of Kepler's equation over the whole range of the solver, and of the distance to the
+            // center of a circle through the spline that approximated it
+            double kepler_residual = 0;
+            for (int e = 0; e <= 99; ++e)
+            {
+                const float eccentricity = std::min(e / 100.0f, KEPLER_MAX_ECCENTRICITY);
+                for (int m = -1000; m <= 1000; ++m)
+                {
+                    const float mean_anomaly = m * static_cast<float>(M_PI) / 1000;
+                    float sin_anomaly, cos_anomaly;
+                    const double eccentric_anomaly = SolveKepler(mean_anomaly, eccentricity, sin_anomaly, cos_anomaly);
+                    kepler_residual = std::max(
+                        kepler_residual, fabs(eccentric_anomaly - eccentricity * sin(eccentric_anomaly) - mean_anomaly)
+                    );
+                }
+            }
+
+            std::vector<Vec3f> circle;
+            for (int i = 0; i < 10; ++i)
+                circle.push_back(Vec3fPolar(1, i * M_PI * 2 / 10));
+            const CatmullRomSpline spline(circle);
+            double spline_radius_error = 0;
+            for (int i = 0; i < 1000; ++i)
+            {
+                Vec3f position, derivative;
+                spline.Evaluate(i / 1000.0f, position, derivative);
+                spline_radius_error = std::max(spline_radius_error, fabs(position.Length() - 1.0));
+            }
+            return {{"kepler_residual", kepler_residual}, {"spline_radius_error", spline_radius_error}};
+        };
+        return benchmark;
+    }
+
+    // Paths like the asteroid belt, every eighth one at constant speed like the comet
+    struct SplineBatchState
+    {
+        std::vector<CatmullRomSpline> splines;
+        std::vector<float> periods;
+        SplineBatch batch;
+        std::vector<Vec3f> positions, derivatives;
+        float time = 0;
+
+        explicit SplineBatchState(const size_t size) : positions(size), derivatives(size)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                splines.emplace_back(circlePath(7, randomFloat(280, 320)), i % 8 == 0);
+                periods.push_back(randomFloat(25, 35));
+                batch.Add(splines.back(), periods.back());
+            }
+        }
+
+        std::vector<float> output() const
+        {
+            auto result = toFloats(positions);
+            const auto derivative_floats = toFloats(derivatives);
+            result.insert(result.end(), derivative_floats.begin(), derivative_floats.end());
+            return result;
+        }
+    };
+
+    // One spline at a time, like the scene traversal before the batch
+    bench::Benchmark splinePerPath(const size_t size)
+    {
+        return createBenchmark<SplineBatchState>(
+            "spline_per_path",
+            size,
+            false,
+            std::make_shared<SplineBatchState>(size),
+            [](SplineBatchState &s)
+            {
+                s.time += 0.016f;
+                for (size_t i = 0; i < s.splines.size(); ++i)
+                    s.splines[i].Evaluate(s.time / s.periods[i], s.positions[i], s.derivatives[i]);
+                bench::sink = s.positions.back().x;
+            },
+            [](SplineBatchState &s) { return s.output(); }
+        );
+    }
+
+    bench::Benchmark splineBatch(const size_t size)
+    {
+        return createBenchmark<SplineBatchState>(
+            "spline_batch",
+            size,
+            true,
+            std::make_shared<SplineBatchState>(size),
+            [](SplineBatchState &s)
+            {
+                s.batch.Evaluate(12.3f);
+                bench::sink = s.batch.GetPosition(s.splines.size() - 1).x;
+            },
+            [](SplineBatchState &s)
+            {
+                for (size_t i = 0; i < s.splines.size(); ++i)
+                {
+                    s.positions[i] = s.batch.GetPosition(i);
+                    s.derivatives[i] = s.batch.GetDerivative(i);
+                }
+                return s.output();
+            }
+        );
+    }
+
+    bench::Benchmark aabbTransform(const size_t size)
+    {
+        struct State
+        {
+            std::vector<AABB> boxes, out;
+            std::vector<Mat3x4f> matrices;
+        };
+        auto state = std::make_shared<State>();
+        state->boxes.resize(size);
+        state->out.resize(size);
+        state->matrices.resize(size);
+        for (auto &box : state->boxes)
+        {
+            box.Extend(randomVec3f(5));
+            box.Extend(randomVec3f(5));
+        }
+        std::ranges::generate(state->matrices, randomTransform);
+
+        return createBenchmark<State>(
+            "aabb_transform",
+            size,
+            false,
+            state,
+            [](State &s)
+            {
+                for (size_t i = 0; i < s.boxes.size(); ++i)
+                    s.out[i] = s.boxes[i].Transform(s.matrices[i]);
+                bench::sink = s.out.back().min.x;
+            },
+            [](State &s) { return toFloats(s.out); }
+        );
+    }
+
+    // Floats ordered as integers, so the difference of two of them is their distance in ulp
+    int64_t orderedBits(const float value)
+    {
+        int32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits < 0 ? -static_cast<int64_t>(bits & 0x7fffffff) : bits;
+    }
+
+    // Compared against sin/cos in double over every 101st float in [-SINCOS_MAX_ANGLE, SINCOS_MAX_ANGLE]. Results
+    // under 2^-10 in magnitude are compared by absolute error instead: near the zeros of the function the ulp gets
+    // arbitrarily small while the reduction error stays the same.
+    std::vector<std::pair<std::string, double>> sinCosAccuracy()
+    {
+        std::vector<float> angles;
+        for (uint32_t bits = 0x30000000;; bits += 101)
+        {
+            float angle;
+            std::memcpy(&angle, &bits, sizeof(angle));
+            if (angle > SINCOS_MAX_ANGLE)
+                break;
+            angles.push_back(angle);
+            angles.push_back(-angle);
+        }
+
+        std::vector<float> sines(angles.size()), cosines(angles.size());
+        SinCosBatch(angles, sines, cosines);
+
+        int64_t max_ulp = 0;
+        double max_absolute_near_zero = 0;
+        for (size_t i = 0; i < angles.size(); ++i)
+        {
+            const double expected_values[] = {sin(static_cast<double>(angles[i])), cos(static_cast<double>(angles[i]))};
+            const float values[] = {sines[i], cosines[i]};
+            for (int k = 0; k < 2; ++k)
+            {
+                if (std::abs(expected_values[k]) >= 1.0 / 1024)
+                {
+                    const auto expected = static_cast<float>(expected_values[k]);
+                    max_ulp = std::max(max_ulp, std::abs(orderedBits(values[k]) - orderedBits(expected)));
+                }
+                else
+                {
+                    max_absolute_near_zero =
+                        std::max(max_absolute_near_zero, std::abs(values[k] - expected_values[k]));
+                }
+            }
+        }
+        return {{"max_ulp", static_cast<double>(max_ulp)}, {"max_absolute_near_zero", max_absolute_near_zero}};
+    }
+
+    struct SinCosState
+    {
+        std::vector<float> angles, sines, cosines;
+
+        explicit SinCosState(const size_t size) : angles(size), sines(size), cosines(size)
+        {
+            std::ranges::generate(angles, [] { return randomFloat(-100, 100); });
+        }
+    };
+
+    bench::Benchmark sinCosLibm(const size_t size)
+    {
+        return createBenchmark<SinCosState>(
+            "sincos_libm",
+            size,
+            false,
+            std::make_shared<SinCosState>(size),
+            [](SinCosState &s)
+            {
+                for (size_t i = 0; i < s.angles.size(); ++i)
+                {
+                    s.sines[i] = sinf(s.angles[i]);
+                    s.cosines[i] = cosf(s.angles[i]);
+                }
+                bench::sink = s.sines.back() + s.cosines.back();
+            },
+            [](SinCosState &s) { return s.sines; }
+        );
+    }
+
+    bench::Benchmark sinCos(const size_t size)
+    {
+        auto benchmark = createBenchmark<SinCosState>(
+            "sincos",
+            size,
+            true,
+            std::make_shared<SinCosState>(size),
+            [](SinCosState &s)
+            {
+                SinCosBatch(s.angles, s.sines, s.cosines);
+                bench::sink = s.sines.back() + s.cosines.back();
+            },
+            [](SinCosState &s)
+            {
+                auto result = s.sines;
+                result.insert(result.end(), s.cosines.begin(), s.cosines.end());
+                return result;
+            }
+        );
+        benchmark.metrics = sinCosAccuracy;
+        return benchmark;
+    }
+
+    enum class TransformEvaluation
+    {
+        VISIT, // a std::visit of every transform, like before the compiled programs
+        COMPILED,
+        BAKED,
+    };
+
+    // Same composition as Engine::evaluateTransform
+    void evaluateTransforms(
+        std::vector<world::GroupTransform> &groups,
+        const float time,
+        const TransformEvaluation evaluation,
+        std::vector<Mat3x4f> &out
+    )
+    {
+        for (size_t i = 0; i < groups.size(); ++i)
+        {
+            if (evaluation == TransformEvaluation::BAKED && groups[i].GetBaked())
+            {
+                out[i] = groups[i].GetBaked()->Evaluate(time);
+                continue;
+            }
+            if (evaluation != TransformEvaluation::VISIT)
+            {
+                out[i] = groups[i].Evaluate(time);
+                continue;
+            }
+
+            Mat3x4f result = Mat3x4fIdentity;
+            for (auto &transform : groups[i].GetTransformations())
+            {
+                result *= std::visit([&](auto &&arg) { return arg.GetTransform(time); }, transform);
+            }
+            out[i] = result;
+        }
+    }
+
+    // The local transforms of the groups in solar_system.xml: 500 asteroids with a 7 point path, a time rotation, a
+    // fixed rotation and a scale, plus 161 planets and moons with a Kepler orbit, a time rotation and a scale.
+    // The time rotations turn a whole number of times per path or orbit, like moons do, so every group can be baked.
+    // Every run advances the time by one 60 fps frame.
+    bench::Benchmark solarSystemTransforms(const TransformEvaluation evaluation)
+    {
+        struct State
+        {
+            std::vector<world::GroupTransform> groups;
+            std::vector<Mat3x4f> out;
+            float time = 0;
+            TransformEvaluation evaluation;
+            world::BakeStats bake_stats;
+        };
+        auto state = std::make_shared<State>();
+        state->evaluation = evaluation;
+
+        for (int i = 0; i < 500 + 161; ++i)
+        {
+            const bool asteroid = i < 500;
+            const float period = randomFloat(20, 35);
+            world::GroupTransform group;
+            if (asteroid)
+            {
+                group.AddTransform(
+                    world::transform::TranslationThroughPoints(period, false, circlePath(7, randomFloat(10, 100)))
+                );
+            }
+            else
+            {
+                group.AddTransform(world::transform::KeplerOrbit(
+                    period, randomFloat(10, 100), randomFloat(0, 0.25f), 0, 0, 0, randomFloat(0, M_PI * 2)
+                ));
+            }
+            const float turns = static_cast<float>(1 + i % 3);
+            group.AddTransform(world::transform::RotationWithTime(period / turns, {0, 1, 0}));
+            if (asteroid)
+                group.AddTransform(world::transform::Rotation(-M_PI_2, {1, 0, 0}));
+            group.AddTransform(world::transform::Scale(Vec3f(asteroid ? 0.075f : 0.1f)));
+            state->groups.push_back(group);
+        }
+        state->out.resize(state->groups.size());
+
+        if (evaluation == TransformEvaluation::BAKED)
+        {
+            world::WorldGroup scene;
+            for (auto &group : state->groups)
+            {
+                scene.children.emplace_back();
+                scene.children.back().transformations = group;
+            }
+            world::BakeTransforms(scene, 0.01f, state->bake_stats);
+            for (size_t i = 0; i < state->groups.size(); ++i)
+                state->groups[i] = scene.children[i].transformations;
+        }
+
+        const char *names[] = {
+            "solar_system_transforms_visit", "solar_system_transforms", "solar_system_transforms_baked"
+        };
+        auto benchmark = createBenchmark<State>(
+            names[static_cast<int>(evaluation)],
+            state->groups.size(),
+            true,
+            state,
+            [](State &s)
+            {
+                s.time += 1.0f / 60;
+                evaluateTransforms(s.groups, s.time, s.evaluation, s.out);
+                bench::sink = s.out.back().cols[3][0];
+            },
+            [](State &s)
+            {
+                // The time rotations advance from the previous frame, start over so every instruction set
+                // evaluates the same thing
+                auto groups = s.groups;
+                for (auto &group : groups)
+                    for (auto &transform : group.GetTransformations())
+                        if (std::holds_alternative<world::transform::RotationWithTime>(transform))
+                            std::get<world::transform::RotationWithTime>(transform).updateRotation();
+
+                std::vector<Mat3x4f> out(groups.size());
+                evaluateTransforms(groups, 12.5f, s.evaluation, out);
+                return toFloats(out);
+            }
+        );
+        if (evaluation == TransformEvaluation::COMPILED)
+        {
+            benchmark.metrics = [state]() -> std::vector<std::pair<std::string, double>>
+            {
+                size_t removed_products = 0;
+                for (auto &group : state->groups)
+                    removed_products += group.GetRemovedProducts();
+                return {{"removed_products", static_cast<double>(removed_products)}};
+            };
+        }
+        else if (evaluation == TransformEvaluation::BAKED)
+        {
+            benchmark.metrics = [state]() -> std::vector<std::pair<std::string, double>>
+            {
+                const auto &stats = state->bake_stats;
+                return {
+                    {"baked_groups", static_cast<double>(stats.baked_groups)},
+                    {"keys", static_cast<double>(stats.keys)},
+                    {"bytes", static_cast<double>(stats.bytes)},
+                    {"bake_max_error", stats.max_error},
+                };
+            };
+        }
+        return benchmark;
+    }
+} // namespace
+
+std::vector<bench::Benchmark> CreateMathBenchmarks()
+{
+    return {
+        mat4fMultiply(1024),
+        mat4fVecMultiply(4096),
+        mat3x4fMultiply(1024),
+        transformPoints(4096),
+        transformPoints(1 << 20),
+        vec3fNormalizeCross(4096),
+        catmullRom(4096),
+        catmullRomCached(4096),
+        catmullRomConstantSpeed(4096),
+        keplerOrbit(4096),
+        splinePerPath(1000),
+        splinePerPath(100000),
+        splineBatch(1000),
+        splineBatch(100000),
+        aabbTransform(4096),
+        sinCosLibm(4096),
+        sinCos(4096),
+        solarSystemTransforms(TransformEvaluation::VISIT),
+        solarSystemTransforms(TransformEvaluation::COMPILED),
+        solarSystemTransforms(TransformEvaluation::BAKED),
+    };
+}
@@ -0,0 +1,11 @@
+#ifndef CG_SOLAR_SYSTEM_MATH_BENCHMARKS_H
+#define CG_SOLAR_SYSTEM_MATH_BENCHMARKS_H
+
+#include <vector>
+
+#include "Benchmark.h"
+
+// Benchmarks of the common/ math primitives, with input sizes taken from the solar system scene and the generators
+std::vector<bench::Benchmark> CreateMathBenchmarks();
+
+#endif // CG_SOLAR_SYSTEM_MATH_BENCHMARKS_H
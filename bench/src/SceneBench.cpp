@@ -0,0 +1,344 @@
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Frustum.h"
+#include "JobSystem.h"
+#include "Model.h"
+#include "RenderQueue.h"
+#include "Scene.h"
+#include "Simd.h"
+#include "World.h"
+
+struct Options
+{
+    size_t asteroids = 100000;
+    size_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::chrono::milliseconds min_time{1000};
+    bool culling = false;
+};
+
+void printHelp()
+{
+    std::cout << "Usage: cg-bench-scene [options]" << std::endl;
+    std::cout << "Prints one JSON object per thread count updating, culling and sorting the draws of a generated"
+              << " asteroid belt." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "\t--asteroids <count>\tasteroids of the belt (default 100000)" << std::endl;
+    std::cout << "\t--threads <count>\thighest thread count measured (default the hardware threads)" << std::endl;
+    std::cout << "\t--min-time <ms>\t\tminimum measured time of each thread count (default 1000)" << std::endl;
+    std::cout << "\t--culling\t\tcompares instead the culling of belts of 1000, 10000 and 100000 asteroids and of"
+              << " a solar system with a linear scan and the group bounds" << std::endl;
+}
+
+std::optional<Options> parseOptions(const int argc, char *argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--asteroids") == 0 && has_value)
+        {
+            options.asteroids = std::stoul(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && has_value)
+        {
+            options.max_threads = std::max(std::stoul(argv[++i]), 1ul);
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && has_value)
+        {
+            options.min_time = std::chrono::milliseconds(std::stoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--culling") == 0)
+        {
+            options.culling = true;
+        }
+        else
+        {
+            printHelp();
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+std::mt19937 random_engine(42);
+
+float randomFloat(const float min, const float max)
+{
+    return std::uniform_real_distribution<float>(min, max)(random_engine);
+}
+
+// Points of a circle of radius around the y axis at height, from the angle start, for TranslationThroughPoints
+std::vector<Vec3f> createOrbit(const float radius, const float height, const float start, const int count)
+{
+    std::vector<Vec3f> points;
+    for (int point = 0; point < count; ++point)
+    {
+        const float angle = start + static_cast<float>(M_PI * 2 * point / count);
+        points.push_back({radius * sinf(angle), height, radius * cosf(angle)});
+    }
+    return points;
+}
+
+// Asteroid of the belts of the generator, following an aligned 7 point path around the sun, turned and scaled
+world::WorldGroup createAsteroid(const size_t index, const float distance, const float height, const float scale)
+{
+    const float start = randomFloat(0, M_PI * 2);
+    const std::vector<Vec3f> points = createOrbit(distance, height, start, 7);
+
+    world::WorldGroup asteroid("Asteroid " + std::to_string(index + 1));
+    asteroid.transformations.AddTransform(
+        world::transform::TranslationThroughPoints(randomFloat(25, 35), true, points)
+    );
+    asteroid.transformations.AddTransform(world::transform::Rotation(-M_PI_2, {1, 0, 0}));
+    asteroid.transformations.AddTransform(world::transform::Scale(Vec3f(scale)));
+    asteroid.models.push_back({});
+    return asteroid;
+}
+
+// Like the asteroid belt of the generator: a static sun, and asteroids around it. Every group has the one model.
+world::WorldGroup createAsteroidBelt(const size_t asteroids)
+{
+    world::WorldGroup root("Solar System");
+    world::WorldGroup sun("Sun");
+    sun.transformations.AddTransform(world::transform::Scale(Vec3f(20)));
+    sun.models.push_back({});
+    root.children.push_back(std::move(sun));
+
+    world::WorldGroup belt("Asteroid Belt");
+    for (size_t i = 0; i < asteroids; ++i)
+    {
+        const float distance = randomFloat(280, 320);
+        const float height = randomFloat(-20, 20);
+        belt.children.push_back(createAsteroid(i, distance, height, 0.5f));
+    }
+    root.children.push_back(std::move(belt));
+    return root;
+}
+
+// Moon of the solar system of the generator, orbiting its planet
+world::WorldGroup createMoon(const size_t index, const float distance, const float period)
+{
+    const std::vector<Vec3f> points = createOrbit(distance, 0, randomFloat(0, M_PI * 2), 10);
+
+    world::WorldGroup moon("Moon " + std::to_string(index + 1));
+    moon.transformations.AddTransform(world::transform::TranslationThroughPoints(period, false, points));
+    moon.transformations.AddTransform(world::transform::Scale(Vec3f(0.1f)));
+    moon.models.push_back({});
+    return moon;
+}
+
+// Like the solar system scene of the generator, with about its sizes and periods: a static skybox around everything,
+// the turning sun, the planets orbiting it with their moons orbiting them, and a belt of 500 asteroids past Mars.
+// Every group has the one model.
+world::WorldGroup createSolarSystem()
+{
+    struct Planet
+    {
+        const char *name;
+        float distance;
+        float period;
+        float scale;
+        size_t moons;
+        float moon_distance;
+        float moon_period;
+    };
+    constexpr Planet PLANETS[] = {
+        {"Mercury", 17.6f, 32.3f, 0.41f, 0, 0, 0},
+        {"Venus", 22.9f, 39.1f, 1.01f, 0, 0, 0},
+        {"Earth", 27.2f, 42.6f, 1.06f, 1, 3.5f, 17.0f},
+        {"Mars", 35.4f, 47.1f, 0.57f, 2, 1.7f, 18.8f},
+        {"Jupiter", 92.7f, 60.4f, 11.92f, 67, 30.3f, 24.2f},
+        {"Saturn", 160.9f, 67.0f, 10.04f, 61, 25.6f, 26.8f},
+        {"Uranus", 310.8f, 74.5f, 4.26f, 27, 11.1f, 29.8f},
+        {"Neptune", 479.9f, 79.3f, 4.13f, 14, 10.8f, 31.7f},
+    };
+
+    world::WorldGroup root("Solar System");
+    world::WorldGroup skybox("Skybox");
+    skybox.transformations.AddTransform(world::transform::Scale(Vec3f(500)));
+    skybox.models.push_back({});
+    root.children.push_back(std::move(skybox));
+
+    world::WorldGroup sun("Sun");
+    sun.transformations.AddTransform(world::transform::Scale(Vec3f(11.6f)));
+    sun.transformations.AddTransform(world::transform::RotationWithTime(46.7f, {0, 1, 0}));
+    sun.models.push_back({});
+    root.children.push_back(std::move(sun));
+
+    for (const auto &planet : PLANETS)
+    {
+        world::WorldGroup system(std::string("Planetery of ") + planet.name);
+        const std::vector<Vec3f> orbit = createOrbit(planet.distance, 0, randomFloat(0, M_PI * 2), 10);
+        system.transformations.AddTransform(world::transform::TranslationThroughPoints(planet.period, false, orbit));
+
+        world::WorldGroup body(std::string("Planet ") + planet.name);
+        body.transformations.AddTransform(world::transform::Scale(Vec3f(planet.scale)));
+        body.transformations.AddTransform(world::transform::RotationWithTime(randomFloat(10, 30), {0, 1, 0}));
+        body.models.push_back({});
+        system.children.push_back(std::move(body));
+
+        for (size_t i = 0; i < planet.moons; ++i)
+        {
+            const float distance = planet.moon_distance + randomFloat(-0.5f, 0.5f);
+            system.children.push_back(createMoon(i, distance, planet.moon_period));
+        }
+        root.children.push_back(std::move(system));
+    }
+
+    world::WorldGroup belt("Asteroid Belt");
+    for (size_t i = 0; i < 500; ++i)
+    {
+        const float distance = randomFloat(40.8f, 45);
+        const float height = randomFloat(-2, 2);
+        belt.children.push_back(createAsteroid(i, distance, height, 0.075f));
+    }
+    root.children.push_back(std::move(belt));
+    return root;
+}
+
+// Culls the same frame of a scene on one thread with every method of the engine: a linear scan of the instance
+// bounds with Scene::Cull and the bounds of the group tree with Scene::CullGroups
+void benchmarkCulling(
+    const Options &options,
+    const std::string &prefix,
+    world::WorldGroup &root,
+    std::vector<engine::model::Model> &models,
+    const Frustum &frustum
+)
+{
+    engine::JobSystem jobs(1);
+    engine::Scene scene;
+    scene.Build(root, models);
+    scene.Update(jobs, [](world::GroupTransform &transforms) { return transforms.Evaluate(1.0f / 60); });
+
+    const size_t instances = scene.GetInstanceCount();
+    const double linear_ns = bench::MeasureNsPerOp(1, [&] { scene.Cull(frustum, jobs); }, options.min_time);
+    const size_t linear_visible = scene.GetVisibleInstances();
+    const double groups_ns = bench::MeasureNsPerOp(1, [&] { scene.CullGroups(frustum, jobs); }, options.min_time);
+    const size_t groups_visible = scene.GetVisibleInstances();
+
+    const auto print = [&](const std::string &name, const double ns, const size_t visible, auto &&extra)
+    {
+        bench::Result result = {
+            prefix + name,
+            simd::GetName(simd::GetActive()),
+            instances,
+            ns / static_cast<double>(instances),
+            std::abs(static_cast<double>(visible) - static_cast<double>(linear_visible)),
+            {
+                {"us_per_query", ns / 1e3},
+                {"speedup", linear_ns / ns},
+                {"visible_instances", static_cast<double>(visible)},
+            },
+        };
+        result.metrics.insert(result.metrics.end(), extra.begin(), extra.end());
+        bench::PrintJson(result);
+    };
+    using Metrics = std::vector<std::pair<std::string, double>>;
+    print("_linear", linear_ns, linear_visible, Metrics{});
+    print(
+        "_groups",
+        groups_ns,
+        groups_visible,
+        Metrics{
+            {"tested_nodes", static_cast<double>(scene.GetTestedNodes())},
+            {"skipped_nodes", static_cast<double>(scene.GetSkippedNodes())},
+        }
+    );
+}
+
+int main(const int argc, char *argv[])
+{
+    const auto options = parseOptions(argc, argv);
+    if (!options.has_value())
+        return 1;
+
+    std::vector<engine::model::Model> models;
+    models.emplace_back("unit_cube");
+    models[0].GetAABB().Extend({-1, -1, -1});
+    models[0].GetAABB().Extend({1, 1, 1});
+
+    // From next to the sun towards one side of the belt, so most of it is culled
+    const Frustum frustum = CreateFrustumFromCamera({0, 30, 0}, {0, 0, 300}, {0, 1, 0}, 60, 16.0f / 9, 1, 2000);
+
+    if (options->culling)
+    {
+        for (const size_t asteroids : {1000, 10000, 100000})
+        {
+            world::WorldGroup root = createAsteroidBelt(asteroids);
+            benchmarkCulling(*options, "frustum_cull", root, models, frustum);
+        }
+        // From the camera of the scene of the generator, looking at the sun from above the inner planets
+        world::WorldGroup root = createSolarSystem();
+        const Frustum solar_system_frustum =
+            CreateFrustumFromCamera({25, 35, 30}, {0, 7, 0}, {0, 1, 0}, 60, 1.2f, 0.1f, 1000);
+        benchmarkCulling(*options, "solar_system_cull", root, models, solar_system_frustum);
+        return 0;
+    }
+
+    world::WorldGroup root = createAsteroidBelt(options->asteroids);
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < options->max_threads; threads *= 2)
+        thread_counts.push_back(threads);
+    thread_counts.push_back(options->max_threads);
+
+    double single_thread_ns = 0;
+    for (const size_t threads : thread_counts)
+    {
+        engine::JobSystem jobs(threads);
+        engine::Scene scene;
+        scene.Build(root, models);
+        engine::RenderQueue render_queue;
+
+        float time = 0;
+        size_t frames = 0;
+        const auto frame = [&]
+        {
+            time += 1.0f / 60;
+            frames++;
+            scene.Update(jobs, [time](world::GroupTransform &transforms) { return transforms.Evaluate(time); });
+            scene.Cull(frustum, jobs);
+            render_queue.Collect(scene, true);
+            render_queue.Sort();
+            render_queue.Batch();
+            bench::sink = scene.GetWorldTransform(scene.GetNodeCount() - 1).cols[3][0];
+        };
+        frame(); // the first Update evaluates even the static groups and compiles every transform
+        jobs.ResetSteals();
+        frames = 0;
+
+        const double ns = bench::MeasureNsPerOp(1, frame, options->min_time);
+        if (threads == 1)
+            single_thread_ns = ns;
+
+        bench::PrintJson({
+            "scene_update_cull_queue",
+            simd::GetName(simd::GetActive()),
+            scene.GetInstanceCount(),
+            ns / static_cast<double>(scene.GetInstanceCount()),
+            0,
+            {
+                {"threads", static_cast<double>(threads)},
+                {"ms_per_frame", ns / 1e6},
+                {"speedup", single_thread_ns / ns},
+                {"steals_per_frame", static_cast<double>(jobs.GetSteals()) / static_cast<double>(frames)},
+                {"evaluated_transforms", static_cast<double>(scene.GetEvaluatedTransforms())},
+                {"visible_instances", static_cast<double>(scene.GetVisibleInstances())},
+                {"tested_nodes", static_cast<double>(scene.GetTestedNodes())},
+                {"skipped_nodes", static_cast<double>(scene.GetSkippedNodes())},
+                {"draw_packets", static_cast<double>(render_queue.GetPackets().size())},
+                {"draw_batches", static_cast<double>(render_queue.GetBatches().size())},
+            },
+        });
+    }
+    return 0;
+}
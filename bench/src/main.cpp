@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "MathBenchmarks.h"
+#include "Simd.h"
+
+struct Options
+{
+    std::string filter; // only benchmarks whose name contains it
+    std::optional<simd::InstructionSet> instruction_set; // all supported ones if empty
+    std::chrono::milliseconds min_time{200};
+};
+
+std::optional<simd::InstructionSet> getInstructionSet(std::string name)
+{
+    std::ranges::transform(name, name.begin(), [](const unsigned char c) { return std::tolower(c); });
+    for (int i = 0; i < static_cast<int>(simd::InstructionSet::COUNT); ++i)
+    {
+        std::string set_name = simd::GetName(static_cast<simd::InstructionSet>(i));
+        std::ranges::transform(set_name, set_name.begin(), [](const unsigned char c) { return std::tolower(c); });
+        if (set_name == name)
+        {
+            return static_cast<simd::InstructionSet>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+void printHelp()
+{
+    std::cout << "Usage: cg-bench-math [options]" << std::endl;
+    std::cout << "Prints one JSON object per benchmark and instruction set." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "\t--filter <text>\t\tonly run benchmarks whose name contains text" << std::endl;
+    std::cout << "\t--isa <name>\t\tonly run the given instruction set (scalar, sse4, avx2, neon)" << std::endl;
+    std::cout << "\t--min-time <ms>\t\tminimum measured time of each benchmark (default 200)" << std::endl;
+}
+
+std::optional<Options> parseOptions(const int argc, char *argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && has_value)
+        {
+            options.filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--isa") == 0 && has_value)
+        {
+            options.instruction_set = getInstructionSet(argv[++i]);
+            if (!options.instruction_set.has_value() || !simd::IsSupported(*options.instruction_set))
+            {
+                std::cerr << "Instruction set " << argv[i] << " is not supported by this CPU" << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && has_value)
+        {
+            options.min_time = std::chrono::milliseconds(std::stoi(argv[++i]));
+        }
+        else
+        {
+            printHelp();
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+void runBenchmark(const bench::Benchmark &benchmark, const Options &options)
+{
+    if (!benchmark.dispatched)
+    {
+        const double ns = bench::MeasureNsPerOp(benchmark.size, benchmark.run, options.min_time);
+        auto metrics = benchmark.metrics ? benchmark.metrics() : std::vector<std::pair<std::string, double>>{};
+        bench::PrintJson({benchmark.name, "none", benchmark.size, ns, 0, std::move(metrics)});
+        return;
+    }
+
+    // Every instruction set is verified against the scalar results
+    simd::SetActive(simd::InstructionSet::SCALAR);
+    benchmark.run();
+    const std::vector<float> expected = benchmark.output();
+
+    for (int i = 0; i < static_cast<int>(simd::InstructionSet::COUNT); ++i)
+    {
+        const auto set = static_cast<simd::InstructionSet>(i);
+        if (options.instruction_set.has_value() && *options.instruction_set != set)
+            continue;
+        if (!simd::SetActive(set))
+            continue;
+
+        const double ns = bench::MeasureNsPerOp(benchmark.size, benchmark.run, options.min_time);
+
+        const std::vector<float> output = benchmark.output();
+        double max_error = 0;
+        for (size_t k = 0; k < output.size(); ++k)
+        {
+            max_error = std::max(max_error, static_cast<double>(std::abs(output[k] - expected[k])));
+        }
+
+        auto metrics = benchmark.metrics ? benchmark.metrics() : std::vector<std::pair<std::string, double>>{};
+        bench::PrintJson({benchmark.name, simd::GetName(set), benchmark.size, ns, max_error, std::move(metrics)});
+    }
+}
+
+int main(const int argc, char *argv[])
+{
+    const auto options = parseOptions(argc, argv);
+    if (!options.has_value())
+        return 1;
+
+    const auto default_set = simd::GetActive();
+    for (const auto &benchmark : CreateMathBenchmarks())
+    {
+        if (benchmark.name.find(options->filter) == std::string::npos)
+            continue;
+
+        runBenchmark(benchmark, *options);
+        simd::SetActive(default_set);
+    }
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "BakedAnimation.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "Quat.h"
+
+namespace
+{
+    struct Trs
+    {
+        Vec3f translation;
+        Quatf rotation;
+        Vec3f scale;
+    };
+
+    Trs decompose(const Mat3x4f &matrix)
+    {
+        Trs trs;
+        trs.translation = {matrix.cols[3][0], matrix.cols[3][1], matrix.cols[3][2]};
+
+        Vec3f axes[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            axes[i] = {matrix.cols[i][0], matrix.cols[i][1], matrix.cols[i][2]};
+            trs.scale[i] = axes[i].Length();
+        }
+        // A mirroring transform has no rotation, its reflection goes to the scale of x
+        if (axes[0].Cross(axes[1]).Dot(axes[2]) < 0)
+            trs.scale.x = -trs.scale.x;
+
+        Mat3x4f rotation = Mat3x4fIdentity;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (trs.scale[i] == 0)
+                continue;
+            for (int row = 0; row < 3; ++row)
+                rotation.cols[i][row] = axes[i][row] / trs.scale[i];
+        }
+        trs.rotation = QuatfFromMat3x4f(rotation).Normalize();
+        return trs;
+    }
+
+    Mat3x4f compose(const Vec3f &translation, const Quatf &rotation, const Vec3f &scale)
+    {
+        Mat3x4f matrix = rotation.ToMat3x4f();
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int row = 0; row < 3; ++row)
+                matrix.cols[i][row] *= scale[i];
+        }
+        matrix.cols[3][0] = translation.x;
+        matrix.cols[3][1] = translation.y;
+        matrix.cols[3][2] = translation.z;
+        return matrix;
+    }
+
+    float cornerError(const Mat3x4f &a, const Mat3x4f &b)
+    {
+        float error = 0;
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const Vec3f point = {corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f};
+            error = std::max(error, (a.TransformPoint(point) - b.TransformPoint(point)).Length());
+        }
+        return error;
+    }
+
+    // Range of one component over all the keys, split in 65535 steps
+    void quantizationRange(const std::vector<Vec3f> &values, Vec3f &min, Vec3f &step)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            const auto [low, high] = std::ranges::minmax(values, {}, [i](const Vec3f &value) { return value[i]; });
+            min[i] = low[i];
+            step[i] = (high[i] - low[i]) / 65535;
+        }
+    }
+
+    uint16_t quantize(const float value, const float min, const float step)
+    {
+        if (step == 0)
+            return 0;
+        return static_cast<uint16_t>(std::clamp(lroundf((value - min) / step), 0L, 65535L));
+    }
+
+    int16_t quantizeUnit(const float value)
+    {
+        return static_cast<int16_t>(lroundf(std::clamp(value, -1.0f, 1.0f) * 32767));
+    }
+} // namespace
+
+Mat3x4f BakedAnimation::evaluateKey(const size_t index, const float fraction) const
+{
+    const BakedKey &a = m_keys[index];
+    const BakedKey &b = m_keys[index + 1];
+
+    Vec3f translation, scale;
+    for (int i = 0; i < 3; ++i)
+    {
+        const float translation_steps = a.translation[i] + (b.translation[i] - a.translation[i]) * fraction;
+        const float scale_steps = a.scale[i] + (b.scale[i] - a.scale[i]) * fraction;
+        translation[i] = m_translation_min[i] + m_translation_step[i] * translation_steps;
+        scale[i] = m_scale_min[i] + m_scale_step[i] * scale_steps;
+    }
+
+    // Consecutive keys are on the same side of the quaternion sphere, no need for the shortest path check of nlerp
+    Quatf rotation;
+    float *components[4] = {&rotation.w, &rotation.x, &rotation.y, &rotation.z};
+    for (int i = 0; i < 4; ++i)
+        *components[i] = a.rotation[i] + (b.rotation[i] - a.rotation[i]) * fraction;
+
+    return compose(translation, rotation.Normalize(), scale);
+}
+
+std::optional<BakedAnimation> BakedAnimation::Bake(
+    const float period,
+    const float tolerance,
+    const std::function<Mat3x4f(float)> &evaluate
+)
+{
+    const auto sample_time = [period](const size_t index, const size_t count)
+    { return static_cast<float>(static_cast<double>(period) * index / count); };
+
+    // The transform at every key and halfway between them. Doubling the keys turns all of these into keys, so only
+    // the new halfway points are evaluated.
+    std::vector<Mat3x4f> samples(BAKE_MIN_KEYS * 2);
+    for (size_t i = 0; i < samples.size(); ++i)
+        samples[i] = evaluate(sample_time(i, samples.size()));
+
+    for (size_t keys = BAKE_MIN_KEYS; keys <= BAKE_MAX_KEYS; keys *= 2)
+    {
+        if (keys > BAKE_MIN_KEYS)
+        {
+            std::vector<Mat3x4f> refined(keys * 2);
+            for (size_t i = 0; i < keys; ++i)
+            {
+                refined[i * 2] = samples[i];
+                refined[i * 2 + 1] = evaluate(sample_time(i * 2 + 1, refined.size()));
+            }
+            samples = std::move(refined);
+        }
+
+        std::vector<Trs> trs(keys + 1);
+        std::vector<Vec3f> translations(keys), scales(keys);
+        for (size_t i = 0; i < keys; ++i)
+        {
+            trs[i] = decompose(samples[i * 2]);
+            if (i > 0 && trs[i].rotation.Dot(trs[i - 1].rotation) < 0)
+                trs[i].rotation = -trs[i].rotation;
+            translations[i] = trs[i].translation;
+            scales[i] = trs[i].scale;
+        }
+        trs[keys] = trs[0];
+        if (trs[keys].rotation.Dot(trs[keys - 1].rotation) < 0)
+            trs[keys].rotation = -trs[keys].rotation;
+
+        BakedAnimation animation;
+        animation.m_period = period;
+        quantizationRange(translations, animation.m_translation_min, animation.m_translation_step);
+        quantizationRange(scales, animation.m_scale_min, animation.m_scale_step);
+        for (const auto &[translation, rotation, scale] : trs)
+        {
+            BakedKey key;
+            for (int i = 0; i < 3; ++i)
+            {
+                key.translation[i] =
+                    quantize(translation[i], animation.m_translation_min[i], animation.m_translation_step[i]);
+                key.scale[i] = quantize(scale[i], animation.m_scale_min[i], animation.m_scale_step[i]);
+            }
+            key.rotation[0] = quantizeUnit(rotation.w);
+            key.rotation[1] = quantizeUnit(rotation.x);
+            key.rotation[2] = quantizeUnit(rotation.y);
+            key.rotation[3] = quantizeUnit(rotation.z);
+            animation.m_keys.push_back(key);
+        }
+
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const Mat3x4f baked = animation.evaluateKey(i / 2, i % 2 == 0 ? 0.0f : 0.5f);
+            animation.m_max_error = std::max(animation.m_max_error, cornerError(baked, samples[i]));
+        }
+        if (animation.m_max_error <= tolerance)
+            return animation;
+    }
+    return std::nullopt;
+}
+
+Mat3x4f BakedAnimation::Evaluate(const float time) const
+{
+    const double turns = static_cast<double>(time) / m_period;
+    const float key_time = static_cast<float>(turns - floor(turns)) * static_cast<float>(GetKeyCount());
+    const size_t index = std::min(static_cast<size_t>(key_time), GetKeyCount() - 1);
+    return evaluateKey(index, key_time - static_cast<float>(index));
+}
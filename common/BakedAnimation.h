@@ -0,0 +1,57 @@
+#ifndef CG_SOLAR_SYSTEM_BAKED_ANIMATION_H
+#define CG_SOLAR_SYSTEM_BAKED_ANIMATION_H
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "Mat.h"
+#include "Vec.h"
+
+// Keys per period of a BakedAnimation, doubled from the minimum until the animation is within tolerance
+constexpr size_t BAKE_MIN_KEYS = 16;
+constexpr size_t BAKE_MAX_KEYS = 4096;
+
+// Translation, rotation and scale of one key, each component quantized to 16 bits. Translation and scale are
+// relative to their range over the whole animation, the rotation is a unit quaternion w x y z.
+struct BakedKey
+{
+    uint16_t translation[3];
+    uint16_t scale[3];
+    int16_t rotation[4];
+};
+
+// A periodic transform sampled over its period into evenly spaced keys, interpolated linearly (the rotation with
+// nlerp) so evaluating it costs the same whatever it was baked from. Only transforms without shear can be baked.
+class BakedAnimation
+{
+    std::vector<BakedKey> m_keys; // with the first one repeated at the end
+    float m_period = 1;
+    Vec3f m_translation_min, m_translation_step;
+    Vec3f m_scale_min, m_scale_step;
+    // Largest distance between a corner of the cube [-1, 1]^3 transformed by the animation and by what it was baked
+    // from, at every key and halfway between them
+    float m_max_error = 0;
+
+    Mat3x4f evaluateKey(size_t index, float fraction) const;
+
+public:
+    // Bakes evaluate over [0, period[ with the fewest keys that stay within tolerance, or nothing if even
+    // BAKE_MAX_KEYS can't
+    static std::optional<BakedAnimation> Bake(
+        float period,
+        float tolerance,
+        const std::function<Mat3x4f(float)> &evaluate
+    );
+
+    // time wraps around the period
+    Mat3x4f Evaluate(float time) const;
+
+    size_t GetKeyCount() const { return m_keys.size() - 1; }
+    size_t GetBytes() const { return m_keys.size() * sizeof(BakedKey); }
+    float GetPeriod() const { return m_period; }
+    float GetMaxError() const { return m_max_error; }
+};
+
+#endif // CG_SOLAR_SYSTEM_BAKED_ANIMATION_H
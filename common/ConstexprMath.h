@@ -0,0 +1,79 @@
+#ifndef CG_SOLAR_SYSTEM_CONSTEXPR_MATH_H
+#define CG_SOLAR_SYSTEM_CONSTEXPR_MATH_H
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <type_traits>
+
+// Math functions usable in constant expressions, so fixed transforms can be folded at compile time.
+// At runtime they fall back to the C library.
+namespace constmath
+{
+    struct SinCosResult
+    {
+        float sin, cos;
+    };
+
+    // fabs isn't constexpr until C++23. Adding 0 turns -0 into +0, like fabs does.
+    constexpr float Abs(const float value) { return (value < 0 ? -value : value) + 0.0f; }
+
+    // Approximation evaluated in double: the angle is reduced by quarter turns to [-pi/4, pi/4], where the Taylor
+    // series below is accurate to ~1e-13. After rounding to float the absolute error is under 3e-8 (measured for
+    // |angle| < 1000), so it matches sinf/cosf or is 1 ulp away. Meant for |angle| < 1e6.
+    constexpr SinCosResult SinCosApprox(const float angle)
+    {
+        constexpr double half_pi = 1.57079632679489661923;
+
+        const double quarters = angle / half_pi;
+        const long long k =
+            quarters < 0 ? static_cast<long long>(quarters - 0.5) : static_cast<long long>(quarters + 0.5);
+        const double r = angle - static_cast<double>(k) * half_pi;
+        const double r2 = r * r;
+
+        const double s =
+            r * (1 + r2 * (-1.0 / 6 + r2 * (1.0 / 120 + r2 * (-1.0 / 5040 + r2 * (1.0 / 362880 +
+                 r2 * (-1.0 / 39916800 + r2 * (1.0 / 6227020800)))))));
+        const double c =
+            1 + r2 * (-1.0 / 2 + r2 * (1.0 / 24 + r2 * (-1.0 / 720 + r2 * (1.0 / 40320 +
+                r2 * (-1.0 / 3628800 + r2 * (1.0 / 479001600))))));
+
+        switch (((k % 4) + 4) % 4)
+        {
+            case 0:
+                return {static_cast<float>(s), static_cast<float>(c)};
+            case 1:
+                return {static_cast<float>(c), static_cast<float>(-s)};
+            case 2:
+                return {static_cast<float>(-s), static_cast<float>(-c)};
+            default:
+                return {static_cast<float>(-c), static_cast<float>(s)};
+        }
+    }
+
+    // Angles that are an exact multiple of float(M_PI_2), such as M_PI or -M_PI_2, return exact 0/1/-1 instead of
+    // values off by the rounding of pi, so axis aligned rotations are exact permutations both at compile time and
+    // at runtime.
+    constexpr SinCosResult SinCos(const float angle)
+    {
+        constexpr float half_pi = M_PI_2;
+        const float quarters = angle / half_pi;
+        if (quarters > -1e6f && quarters < 1e6f)
+        {
+            const long long k = quarters < 0 ? static_cast<long long>(quarters - 0.5f)
+                                             : static_cast<long long>(quarters + 0.5f);
+            if (static_cast<float>(k) * half_pi == angle)
+            {
+                constexpr SinCosResult quarter_turns[] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+                return quarter_turns[((k % 4) + 4) % 4];
+            }
+        }
+
+        if (std::is_constant_evaluated())
+        {
+            return SinCosApprox(angle);
+        }
+        return {sinf(angle), cosf(angle)};
+    }
+} // namespace constmath
+
+#endif // CG_SOLAR_SYSTEM_CONSTEXPR_MATH_H
@@ -0,0 +1,86 @@
+#include "Kepler.h"
+
+#include <math.h>
+
+namespace
+{
+    // Largest step of an angle for which advanceSinCos uses the series, still accurate to float precision there
+    constexpr float SERIES_MAX_STEP = 0.5f;
+
+    // sin/cos of angle from those of angle - step, rotating them by step instead of calling sinf/cosf again
+    void advanceSinCos(const float angle, const float step, float &sin_angle, float &cos_angle)
+    {
+        if (fabsf(step) > SERIES_MAX_STEP)
+        {
+            sin_angle = sinf(angle);
+            cos_angle = cosf(angle);
+            return;
+        }
+
+        const float step2 = step * step;
+        const float sin_step = step * (1 - step2 * (1.0f / 6) * (1 - step2 * (1.0f / 20) * (1 - step2 * (1.0f / 42))));
+        const float cos_step = 1 - step2 * 0.5f * (1 - step2 * (1.0f / 12) * (1 - step2 * (1.0f / 30)));
+        const float sin_next = sin_angle * cos_step + cos_angle * sin_step;
+        cos_angle = cos_angle * cos_step - sin_angle * sin_step;
+        sin_angle = sin_next;
+    }
+} // namespace
+
+float SolveKepler(const float mean_anomaly, const float eccentricity, float &sin_anomaly, float &cos_anomaly)
+{
+    sin_anomaly = sinf(mean_anomaly);
+    cos_anomaly = cosf(mean_anomaly);
+
+    // Series of E in the eccentricity up to e^2, M + e sin(M) + e^2 / 2 sin(2M)
+    const float start_step = eccentricity * sin_anomaly * (1 + eccentricity * cos_anomaly);
+    float eccentric_anomaly = mean_anomaly + start_step;
+    advanceSinCos(eccentric_anomaly, start_step, sin_anomaly, cos_anomaly);
+
+    for (int i = 0; i < KEPLER_MAX_ITERATIONS; ++i)
+    {
+        const float error = eccentric_anomaly - eccentricity * sin_anomaly - mean_anomaly;
+        if (fabsf(error) < KEPLER_TOLERANCE)
+            break;
+
+        // Halley's step -f / (f' - f f'' / 2f') with a single division
+        const float derivative = 1 - eccentricity * cos_anomaly;
+        const float step =
+            -error * derivative / (derivative * derivative - 0.5f * error * eccentricity * sin_anomaly);
+
+        eccentric_anomaly += step;
+        advanceSinCos(eccentric_anomaly, step, sin_anomaly, cos_anomaly);
+    }
+    return eccentric_anomaly;
+}
+
+KeplerEllipse::KeplerEllipse(
+    const float semi_major_axis,
+    const float eccentricity,
+    const float inclination,
+    const float ascending_node,
+    const float periapsis_argument
+) :
+    m_eccentricity(eccentricity)
+{
+    // Line of nodes and the direction of motion on it, tilted up by the inclination
+    const Vec3f node = Vec3fPolar(1, ascending_node);
+    const Vec3f node_normal = Vec3fPolar(cosf(inclination), ascending_node + M_PI_2, sinf(inclination));
+
+    const float sin_periapsis = sinf(periapsis_argument);
+    const float cos_periapsis = cosf(periapsis_argument);
+    const float semi_minor_axis = semi_major_axis * sqrtf(1 - eccentricity * eccentricity);
+    m_major_axis = (node * cos_periapsis + node_normal * sin_periapsis) * semi_major_axis;
+    m_minor_axis = (node_normal * cos_periapsis - node * sin_periapsis) * semi_minor_axis;
+}
+
+Vec3f KeplerEllipse::PositionAtEccentricAnomaly(const float eccentric_anomaly) const
+{
+    return position(sinf(eccentric_anomaly), cosf(eccentric_anomaly));
+}
+
+Vec3f KeplerEllipse::PositionAtMeanAnomaly(const float mean_anomaly) const
+{
+    float sin_anomaly, cos_anomaly;
+    SolveKepler(mean_anomaly, m_eccentricity, sin_anomaly, cos_anomaly);
+    return position(sin_anomaly, cos_anomaly);
+}
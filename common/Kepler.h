@@ -0,0 +1,48 @@
+#ifndef CG_SOLAR_SYSTEM_KEPLER_H
+#define CG_SOLAR_SYSTEM_KEPLER_H
+
+#include "Vec.h"
+
+// Highest eccentricity of an elliptic orbit SolveKepler converges for in KEPLER_MAX_ITERATIONS
+constexpr float KEPLER_MAX_ECCENTRICITY = 0.99f;
+constexpr int KEPLER_MAX_ITERATIONS = 4;
+// Error of Kepler's equation at which SolveKepler stops, about the float precision of an angle near pi
+constexpr float KEPLER_TOLERANCE = 4e-7f;
+
+// Eccentric anomaly E of the mean anomaly M, the root of Kepler's equation M = E - e sin(E) for 0 <= e < 1, and its
+// sin/cos. Halley's method from E = M + e sin(M), at most KEPLER_MAX_ITERATIONS steps, which reach KEPLER_TOLERANCE
+// for every mean anomaly up to KEPLER_MAX_ECCENTRICITY. sinf/cosf are only called for M and for steps too large for
+// their series, so orbits of planets and moons (e < 0.25) take two calls whatever the number of steps.
+float SolveKepler(float mean_anomaly, float eccentricity, float &sin_anomaly, float &cos_anomaly);
+
+// Elliptic orbit around the origin, from its Keplerian elements with the angles in radians. With no inclination the
+// orbit lies on the XZ plane, like Vec3fPolar, and goes from +Z to +X. The inclination tilts it around the line of
+// nodes, whose direction is Vec3fPolar(1, ascending_node), and the periapsis argument is measured from it.
+class KeplerEllipse
+{
+    Vec3f m_major_axis; // semi-major axis from the center to the periapsis
+    Vec3f m_minor_axis; // semi-minor axis in the direction of motion at the periapsis
+    float m_eccentricity = 0;
+
+    Vec3f position(const float sin_anomaly, const float cos_anomaly) const
+    {
+        // Relative to the focus, which is the eccentricity times the semi-major axis away from the center
+        return m_major_axis * (cos_anomaly - m_eccentricity) + m_minor_axis * sin_anomaly;
+    }
+
+public:
+    KeplerEllipse() = default;
+    KeplerEllipse(
+        float semi_major_axis,
+        float eccentricity,
+        float inclination,
+        float ascending_node,
+        float periapsis_argument
+    );
+
+    Vec3f PositionAtEccentricAnomaly(float eccentric_anomaly) const;
+    // mean_anomaly in [-pi, pi]
+    Vec3f PositionAtMeanAnomaly(float mean_anomaly) const;
+};
+
+#endif // CG_SOLAR_SYSTEM_KEPLER_H
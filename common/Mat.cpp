@@ -3,166 +3,336 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 
-Mat4f Mat4f::operator*(const Mat4f &other) const
+#include "Simd.h"
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+#ifdef SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace
 {
-    Mat4f result{};
-    for (int i = 0; i < 4; ++i)
+    template <bool POINTS>
+    void transformScalar(const Mat3x4f &m, const Vec3f *input, Vec3f *output, const size_t count)
     {
-        for (int j = 0; j < 4; ++j)
+        for (size_t i = 0; i < count; ++i)
         {
-            result.mat[i][j] = 0;
-            for (int k = 0; k < 4; ++k)
-            {
-                result.mat[i][j] += mat[i][k] * other.mat[k][j];
-            }
+            output[i] = POINTS ? m.TransformPoint(input[i]) : m.TransformDirection(input[i]);
         }
     }
-    return result;
-}
-Vec4f Mat4f::operator*(const Vec4f &other) const
-{
-    Vec4f result;
-    for (int i = 0; i < 4; ++i)
+
+#ifdef SIMD_X86
+    // Each result row is a linear combination of the rows of b weighted by the row of a
+    SIMD_TARGET("sse4.1") void multiplySse4(const Mat4f &a, const Mat4f &b, Mat4f &result)
     {
-        for (int j = 0; j < 4; ++j)
+        const __m128 b0 = _mm_loadu_ps(b.mat[0]);
+        const __m128 b1 = _mm_loadu_ps(b.mat[1]);
+        const __m128 b2 = _mm_loadu_ps(b.mat[2]);
+        const __m128 b3 = _mm_loadu_ps(b.mat[3]);
+
+        for (int i = 0; i < 4; ++i)
         {
-            result[i] += mat[i][j] * other[j];
+            __m128 row = _mm_mul_ps(_mm_set1_ps(a.mat[i][0]), b0);
+            row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.mat[i][1]), b1));
+            row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.mat[i][2]), b2));
+            row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.mat[i][3]), b3));
+            _mm_storeu_ps(result.mat[i], row);
         }
     }
-    return result;
-}
 
-Mat4f &Mat4f::operator*=(const Mat4f &mat4_f)
-{
-    *this = *this * mat4_f;
-    return *this;
-}
+    SIMD_TARGET("sse4.1") void multiplyVecSse4(const Mat4f &a, const Vec4f &v, Vec4f &result)
+    {
+        const __m128 vec = _mm_loadu_ps(&v.x);
+        const __m128 r0 = _mm_mul_ps(_mm_loadu_ps(a.mat[0]), vec);
+        const __m128 r1 = _mm_mul_ps(_mm_loadu_ps(a.mat[1]), vec);
+        const __m128 r2 = _mm_mul_ps(_mm_loadu_ps(a.mat[2]), vec);
+        const __m128 r3 = _mm_mul_ps(_mm_loadu_ps(a.mat[3]), vec);
+        _mm_storeu_ps(&result.x, _mm_hadd_ps(_mm_hadd_ps(r0, r1), _mm_hadd_ps(r2, r3)));
+    }
 
-Mat4f Mat4f::transpose() const
-{
-    Mat4f result{};
-    for (int i = 0; i < 4; ++i)
+    SIMD_TARGET("sse4.1") void multiplyAffineSse4(const Mat3x4f &a, const Mat3x4f &b, Mat3x4f &result)
     {
-        for (int j = 0; j < 4; ++j)
+        const __m128 a0 = _mm_loadu_ps(a.cols[0]);
+        const __m128 a1 = _mm_loadu_ps(a.cols[1]);
+        const __m128 a2 = _mm_loadu_ps(a.cols[2]);
+        const __m128 a3 = _mm_loadu_ps(a.cols[3]);
+
+        for (int c = 0; c < 4; ++c)
         {
-            result.mat[i][j] = mat[j][i];
+            __m128 column = _mm_mul_ps(a0, _mm_set1_ps(b.cols[c][0]));
+            column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(b.cols[c][1])));
+            column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(b.cols[c][2])));
+            _mm_storeu_ps(result.cols[c], column);
         }
+        // a3 has w = 1, which restores the implicit last row
+        _mm_storeu_ps(result.cols[3], _mm_add_ps(_mm_loadu_ps(result.cols[3]), a3));
     }
-    return result;
-}
 
-Mat4f Mat4f::Abs()
-{
-    Mat4f result;
-    for (int i = 0; i < 4; ++i)
+    // {x0 y0 z0 x1} {y1 z1 x2 y2} {z2 x3 y3 z3} -> {x0 x1 x2 x3} {y0 y1 y2 y3} {z0 z1 z2 z3}
+    SIMD_TARGET("sse4.1") void loadSoA(const Vec3f *input, __m128 &x, __m128 &y, __m128 &z)
     {
-        for (int j = 0; j < 4; ++j)
+        const float *data = &input->x;
+        const __m128 v0 = _mm_loadu_ps(data);
+        const __m128 v1 = _mm_loadu_ps(data + 4);
+        const __m128 v2 = _mm_loadu_ps(data + 8);
+
+        x = _mm_shuffle_ps(v0, _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1, 0, 3, 2)), _MM_SHUFFLE(3, 0, 3, 0));
+        y = _mm_shuffle_ps(
+            _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 1, 1)),
+            _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 2, 3, 3)),
+            _MM_SHUFFLE(2, 0, 2, 0)
+        );
+        z = _mm_shuffle_ps(
+            _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2)),
+            _mm_shuffle_ps(v2, v2, _MM_SHUFFLE(3, 3, 0, 0)),
+            _MM_SHUFFLE(2, 0, 2, 0)
+        );
+    }
+
+    // Inverse of loadSoA
+    SIMD_TARGET("sse4.1") void storeSoA(Vec3f *output, const __m128 x, const __m128 y, const __m128 z)
+    {
+        float *data = &output->x;
+        const __m128 xy_low = _mm_unpacklo_ps(x, y); // x0 y0 x1 y1
+        const __m128 xy_high = _mm_unpackhi_ps(x, y); // x2 y2 x3 y3
+
+        _mm_storeu_ps(
+            data, _mm_shuffle_ps(xy_low, _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0))
+        );
+        _mm_storeu_ps(
+            data + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), xy_high, _MM_SHUFFLE(1, 0, 2, 0))
+        );
+        _mm_storeu_ps(
+            data + 8,
+            _mm_shuffle_ps(
+                _mm_shuffle_ps(z, xy_high, _MM_SHUFFLE(2, 2, 2, 2)),
+                _mm_shuffle_ps(xy_high, z, _MM_SHUFFLE(3, 3, 3, 3)),
+                _MM_SHUFFLE(2, 0, 2, 0)
+            )
+        );
+    }
+
+    // Same as the SSE4 kernel but computing two rows per iteration, one in each 128-bit lane
+    SIMD_TARGET("avx2,fma") void multiplyAvx2(const Mat4f &a, const Mat4f &b, Mat4f &result)
+    {
+        const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b.mat[0]));
+        const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b.mat[1]));
+        const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b.mat[2]));
+        const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b.mat[3]));
+
+        for (int i = 0; i < 4; i += 2)
         {
-            result.mat[i][j] = fabs(mat[i][j]);
+            const __m256 a_rows = _mm256_loadu_ps(a.mat[i]);
+            __m256 rows = _mm256_mul_ps(_mm256_shuffle_ps(a_rows, a_rows, 0x00), b0);
+            rows = _mm256_fmadd_ps(_mm256_shuffle_ps(a_rows, a_rows, 0x55), b1, rows);
+            rows = _mm256_fmadd_ps(_mm256_shuffle_ps(a_rows, a_rows, 0xAA), b2, rows);
+            rows = _mm256_fmadd_ps(_mm256_shuffle_ps(a_rows, a_rows, 0xFF), b3, rows);
+            _mm256_storeu_ps(result.mat[i], rows);
         }
     }
-    return result;
-}
 
-Mat4f Mat4fTranslate(const float x, const float y, const float z)
-{
-    return {{{1, 0, 0, x}, {0, 1, 0, y}, {0, 0, 1, z}, {0, 0, 0, 1}}};
-}
+    SIMD_TARGET("avx2,fma") void multiplyVecAvx2(const Mat4f &a, const Vec4f &v, Vec4f &result)
+    {
+        const __m256 vec = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(&v.x));
+        const __m256 r01 = _mm256_mul_ps(_mm256_loadu_ps(a.mat[0]), vec);
+        const __m256 r23 = _mm256_mul_ps(_mm256_loadu_ps(a.mat[2]), vec);
 
-Mat4f Mat4fScale(const float x, const float y, const float z)
-{
-    return {{{x, 0, 0, 0}, {0, y, 0, 0}, {0, 0, z, 0}, {0, 0, 0, 1}}};
-}
+        // lane 0 ends with {d0, d2, d0, d2} and lane 1 with {d1, d3, d1, d3}
+        __m256 sums = _mm256_hadd_ps(r01, r23);
+        sums = _mm256_hadd_ps(sums, sums);
+        const __m128 even = _mm256_castps256_ps128(sums);
+        const __m128 odd = _mm256_extractf128_ps(sums, 1);
+        _mm_storeu_ps(&result.x, _mm_unpacklo_ps(even, odd));
+    }
 
-Mat4f Mat4fRotate(const float angle, const float x, const float y, const float z)
-{
-    const float cosa = cosf(angle);
-    const float sina = sinf(angle);
-
-    return {
-        {{
-             x * x + (1 - x * x) * cosa,
-             x * y * (1 - cosa) - z * sina,
-             x * z * (1 - cosa) + y * sina,
-             0,
-         },
-         {
-             x * y * (1 - cosa) + z * sina,
-             y * y + (1 - y * y) * cosa,
-             y * z * (1 - cosa) - x * sina,
-             0,
-         },
-         {
-             x * z * (1 - cosa) - y * sina,
-             y * z * (1 - cosa) + x * sina,
-             z * z + (1 - z * z) * cosa,
-             0,
-         },
-         {0, 0, 0, 1}}
-    };
-}
+    SIMD_TARGET("avx2,fma") void multiplyAffineAvx2(const Mat3x4f &a, const Mat3x4f &b, Mat3x4f &result)
+    {
+        const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(a.cols[0]));
+        const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(a.cols[1]));
+        const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(a.cols[2]));
+        const __m256 translation = _mm256_setr_ps(0, 0, 0, 0, a.cols[3][0], a.cols[3][1], a.cols[3][2], a.cols[3][3]);
 
-Mat4f Mat4fRotateX(const float angle)
-{
-    const auto c = cosf(angle);
-    const auto s = sinf(angle);
-    return {{{1, 0, 0, 0}, {0, c, -s, 0}, {0, s, c, 0}, {0, 0, 0, 1}}};
-}
+        const __m256 b01 = _mm256_loadu_ps(b.cols[0]);
+        __m256 columns = _mm256_mul_ps(a0, _mm256_shuffle_ps(b01, b01, 0x00));
+        columns = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(b01, b01, 0x55), columns);
+        columns = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(b01, b01, 0xAA), columns);
+        _mm256_storeu_ps(result.cols[0], columns);
 
-Mat4f Mat4fRotateY(const float angle)
-{
-    const auto c = cosf(angle);
-    const auto s = sinf(angle);
-    return {{{c, 0, s, 0}, {0, 1, 0, 0}, {-s, 0, c, 0}, {0, 0, 0, 1}}};
-}
+        const __m256 b23 = _mm256_loadu_ps(b.cols[2]);
+        columns = _mm256_fmadd_ps(a0, _mm256_shuffle_ps(b23, b23, 0x00), translation);
+        columns = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(b23, b23, 0x55), columns);
+        columns = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(b23, b23, 0xAA), columns);
+        _mm256_storeu_ps(result.cols[2], columns);
+    }
 
-Mat4f Mat4fRotateZ(const float angle)
-{
-    const auto c = cosf(angle);
-    const auto s = sinf(angle);
-    return {{{c, -s, 0, 0}, {s, c, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
-}
+    // Two SSE transposes side by side, 8 points per iteration
+    template <bool POINTS>
+    SIMD_TARGET("avx2,fma")
+    void transformAvx2(const Mat3x4f &m, const Vec3f *input, Vec3f *output, const size_t count)
+    {
+        __m256 c[4][3];
+        for (int col = 0; col < 4; ++col)
+            for (int row = 0; row < 3; ++row)
+                c[col][row] = _mm256_set1_ps(m.cols[col][row]);
 
-void getCatmullRomPointSegment(
-    float time,
-    const Vec3f &p0,
-    const Vec3f &p1,
-    const Vec3f &p2,
-    const Vec3f &p3,
-    Vec3f &position,
-    Vec3f &derivative
-)
-{
-    Mat4f catmull_rom_matrix = {
-        {{-0.5f, 1.5f, -1.5f, 0.5f}, {1.0f, -2.5f, 2.0f, -0.5f}, {-0.5f, 0.0f, 0.5f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}}
-    };
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128 x_low, y_low, z_low, x_high, y_high, z_high;
+            loadSoA(input + i, x_low, y_low, z_low);
+            loadSoA(input + i + 4, x_high, y_high, z_high);
+
+            const __m256 x = _mm256_set_m128(x_high, x_low);
+            const __m256 y = _mm256_set_m128(y_high, y_low);
+            const __m256 z = _mm256_set_m128(z_high, z_low);
+
+            __m256 result[3];
+            for (int row = 0; row < 3; ++row)
+            {
+                result[row] = POINTS ? _mm256_fmadd_ps(c[0][row], x, c[3][row]) : _mm256_mul_ps(c[0][row], x);
+                result[row] = _mm256_fmadd_ps(c[1][row], y, result[row]);
+                result[row] = _mm256_fmadd_ps(c[2][row], z, result[row]);
+            }
+
+            storeSoA(
+                output + i,
+                _mm256_castps256_ps128(result[0]),
+                _mm256_castps256_ps128(result[1]),
+                _mm256_castps256_ps128(result[2])
+            );
+            storeSoA(
+                output + i + 4,
+                _mm256_extractf128_ps(result[0], 1),
+                _mm256_extractf128_ps(result[1], 1),
+                _mm256_extractf128_ps(result[2], 1)
+            );
+        }
 
-    Vec4f time_vector = {time * time * time, time * time, time, 1};
-    Vec4f time_derivative_vector = {3 * time * time, 2 * time, 1, 0};
+        transformScalar<POINTS>(m, input + i, output + i, count - i);
+    }
+#endif
 
-    for (int i = 0; i < 3; ++i)
+#ifdef SIMD_NEON
+    void multiplyNeon(const Mat4f &a, const Mat4f &b, Mat4f &result)
     {
-        Vec4f points = {p0[i], p1[i], p2[i], p3[i]};
-        Vec4f result = catmull_rom_matrix * points;
+        const float32x4_t b0 = vld1q_f32(b.mat[0]);
+        const float32x4_t b1 = vld1q_f32(b.mat[1]);
+        const float32x4_t b2 = vld1q_f32(b.mat[2]);
+        const float32x4_t b3 = vld1q_f32(b.mat[3]);
 
-        // position[0] = x, position[1] = y, position[2] = z
-        position[i] = time_vector.matrixMult(result);
-        derivative[i] = time_derivative_vector.matrixMult(result);
+        for (int i = 0; i < 4; ++i)
+        {
+            float32x4_t row = vmulq_n_f32(b0, a.mat[i][0]);
+            row = vmlaq_n_f32(row, b1, a.mat[i][1]);
+            row = vmlaq_n_f32(row, b2, a.mat[i][2]);
+            row = vmlaq_n_f32(row, b3, a.mat[i][3]);
+            vst1q_f32(result.mat[i], row);
+        }
     }
-}
 
-void getCatmullRomPoint(float time, std::vector<Vec3f> points, Vec3f &position, Vec3f &derivative)
-{
-    size_t points_size = points.size();
+    void multiplyVecNeon(const Mat4f &a, const Vec4f &v, Vec4f &result)
+    {
+        const float32x4_t vec = vld1q_f32(&v.x);
+        const float32x4_t r0 = vmulq_f32(vld1q_f32(a.mat[0]), vec);
+        const float32x4_t r1 = vmulq_f32(vld1q_f32(a.mat[1]), vec);
+        const float32x4_t r2 = vmulq_f32(vld1q_f32(a.mat[2]), vec);
+        const float32x4_t r3 = vmulq_f32(vld1q_f32(a.mat[3]), vec);
+        vst1q_f32(&result.x, vpaddq_f32(vpaddq_f32(r0, r1), vpaddq_f32(r2, r3)));
+    }
 
-    float t = time * points_size;
-    int index = floor(t);
-    float time_in_segment = t - index;
+    void multiplyAffineNeon(const Mat3x4f &a, const Mat3x4f &b, Mat3x4f &result)
+    {
+        const float32x4_t a0 = vld1q_f32(a.cols[0]);
+        const float32x4_t a1 = vld1q_f32(a.cols[1]);
+        const float32x4_t a2 = vld1q_f32(a.cols[2]);
 
-    const auto &p0 = points[(index + points_size - 1) % points_size];
-    const auto &p1 = points[(index) % points_size];
-    const auto &p2 = points[(index + 1) % points_size];
-    const auto &p3 = points[(index + 2) % points_size];
+        for (int c = 0; c < 4; ++c)
+        {
+            float32x4_t column = c == 3 ? vld1q_f32(a.cols[3]) : vdupq_n_f32(0);
+            column = vmlaq_n_f32(column, a0, b.cols[c][0]);
+            column = vmlaq_n_f32(column, a1, b.cols[c][1]);
+            column = vmlaq_n_f32(column, a2, b.cols[c][2]);
+            vst1q_f32(result.cols[c], column);
+        }
+    }
 
-    getCatmullRomPointSegment(time_in_segment, p0, p1, p2, p3, position, derivative);
+    // vld3q/vst3q do the structure-of-arrays transposition in the load and store themselves
+    template <bool POINTS>
+    void transformNeon(const Mat3x4f &m, const Vec3f *input, Vec3f *output, const size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const float32x4x3_t points = vld3q_f32(&input[i].x);
+            float32x4x3_t result;
+            for (int row = 0; row < 3; ++row)
+            {
+                float32x4_t value = vdupq_n_f32(POINTS ? m.cols[3][row] : 0.0f);
+                value = vmlaq_n_f32(value, points.val[0], m.cols[0][row]);
+                value = vmlaq_n_f32(value, points.val[1], m.cols[1][row]);
+                value = vmlaq_n_f32(value, points.val[2], m.cols[2][row]);
+                result.val[row] = value;
+            }
+            vst3q_f32(&output[i].x, result);
+        }
+
+        transformScalar<POINTS>(m, input + i, output + i, count - i);
+    }
+#endif
+
+    struct Mat4fKernels
+    {
+        void (*multiply)(const Mat4f &, const Mat4f &, Mat4f &);
+        void (*multiply_vec)(const Mat4f &, const Vec4f &, Vec4f &);
+        void (*multiply_affine)(const Mat3x4f &, const Mat3x4f &, Mat3x4f &);
+        void (*transform_points)(const Mat3x4f &, const Vec3f *, Vec3f *, size_t);
+        void (*transform_directions)(const Mat3x4f &, const Vec3f *, Vec3f *, size_t);
+    };
+
+    // Indexed by simd::InstructionSet, instruction sets not available in this architecture fall back to scalar
+    constexpr Mat4fKernels MAT4F_KERNELS[static_cast<int>(simd::InstructionSet::COUNT)] = {
+#define SCALAR_KERNELS                                                                                                 \
+    {MultiplyScalar, MultiplyScalar, MultiplyScalar, transformScalar<true>, transformScalar<false>}
+
+        SCALAR_KERNELS,
+#ifdef SIMD_X86
+        // The 4 wide transposes of the batched transforms need more shuffles than the compiler vectorized scalar loop,
+        // which is faster with SSE4 alone. Only AVX2 beats it.
+        {multiplySse4, multiplyVecSse4, multiplyAffineSse4, transformScalar<true>, transformScalar<false>},
+        {multiplyAvx2, multiplyVecAvx2, multiplyAffineAvx2, transformAvx2<true>, transformAvx2<false>},
+#else
+        SCALAR_KERNELS,
+        SCALAR_KERNELS,
+#endif
+#ifdef SIMD_NEON
+        {multiplyNeon, multiplyVecNeon, multiplyAffineNeon, transformNeon<true>, transformNeon<false>},
+#else
+        SCALAR_KERNELS,
+#endif
+
+#undef SCALAR_KERNELS
+    };
+
+    const Mat4fKernels &activeKernels() { return MAT4F_KERNELS[static_cast<int>(simd::GetActive())]; }
+} // namespace
+
+void MultiplyDispatch(const Mat4f &a, const Mat4f &b, Mat4f &result) { activeKernels().multiply(a, b, result); }
+
+void MultiplyDispatch(const Mat4f &a, const Vec4f &v, Vec4f &result) { activeKernels().multiply_vec(a, v, result); }
+
+void MultiplyDispatch(const Mat3x4f &a, const Mat3x4f &b, Mat3x4f &result)
+{
+    activeKernels().multiply_affine(a, b, result);
+}
+
+void TransformPoints(const Mat3x4f &matrix, const std::span<const Vec3f> points, const std::span<Vec3f> result)
+{
+    activeKernels().transform_points(matrix, points.data(), result.data(), points.size());
+}
+
+void TransformDirections(const Mat3x4f &matrix, const std::span<const Vec3f> directions, const std::span<Vec3f> result)
+{
+    activeKernels().transform_directions(matrix, directions.data(), result.data(), directions.size());
 }
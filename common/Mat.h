@@ -1,37 +1,394 @@
 #ifndef MAT_H
 #define MAT_H
 
+#include <ConstexprMath.h>
 #include <Vec.h>
+#include <span>
+#include <type_traits>
 #include <vector>
 
+struct Mat3x4f;
+
+// The whole matrix API is constexpr so fixed transforms fold at compile time. Products run the scalar reference
+// code in constant expressions and the SIMD kernels of simd::GetActive() at runtime.
 struct Mat4f
 {
     float mat[4][4];
-    Mat4f operator*(const Mat4f &other) const;
-    Vec4f operator*(const Vec4f &other) const;
-    Mat4f &operator*=(const Mat4f &mat4_f);
-    Mat4f transpose() const;
-    Mat4f Abs();
+    constexpr Mat4f operator*(const Mat4f &other) const;
+    constexpr Vec4f operator*(const Vec4f &other) const;
+    constexpr Mat4f &operator*=(const Mat4f &mat4_f);
+    constexpr Mat4f transpose() const;
+    constexpr Mat4f Abs() const;
+    constexpr Mat3x4f ToMat3x4f() const;
+};
+
+// Affine transform (a 3x4 matrix with an implicit last row of 0 0 0 1) used for all scene transforms.
+// Stored column-major with padded columns, the same layout OpenGL expects, so it can be passed to glMultMatrixf
+// without transposing. Composing two of them skips the last row, 48 multiplications instead of 64.
+struct Mat3x4f
+{
+    float cols[4][4]; // cols[column][row], row 3 is always 0 except for the translation column
+
+    constexpr Mat3x4f operator*(const Mat3x4f &other) const;
+    constexpr Mat3x4f &operator*=(const Mat3x4f &other);
+    // Same as *= Mat3x4fTranslate / Mat3x4fScale, without the full product
+    constexpr Mat3x4f &Translate(float x, float y, float z);
+    constexpr Mat3x4f &Scale(float x, float y, float z);
+    constexpr Vec3f TransformPoint(const Vec3f &point) const;
+    constexpr Vec3f TransformDirection(const Vec3f &direction) const;
+    constexpr Vec3f GetTranslation() const { return {cols[3][0], cols[3][1], cols[3][2]}; }
+    constexpr Mat3x4f Abs() const;
+    // Inverse of the affine transform, with infinities or NaN if it isn't invertible (a scale of 0)
+    constexpr Mat3x4f Inverse() const;
+    constexpr Mat4f ToMat4f() const;
+    const float *Data() const { return &cols[0][0]; }
 };
 
-Mat4f Mat4fTranslate(float x, float y, float z);
-Mat4f Mat4fScale(float x, float y, float z);
-Mat4f Mat4fRotate(float angle, float x, float y, float z);
-Mat4f Mat4fRotateX(float angle);
-Mat4f Mat4fRotateY(float angle);
-Mat4f Mat4fRotateZ(float angle);
+// Scalar reference products, every SIMD kernel must match them
+constexpr void MultiplyScalar(const Mat4f &a, const Mat4f &b, Mat4f &result)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            result.mat[i][j] = 0;
+            for (int k = 0; k < 4; ++k)
+            {
+                result.mat[i][j] += a.mat[i][k] * b.mat[k][j];
+            }
+        }
+    }
+}
+
+constexpr void MultiplyScalar(const Mat4f &a, const Vec4f &v, Vec4f &result)
+{
+    result = {};
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            result[i] += a.mat[i][j] * v[j];
+        }
+    }
+}
+
+// Each result column is a combination of the linear columns of a, plus a's translation for the last one
+constexpr void MultiplyScalar(const Mat3x4f &a, const Mat3x4f &b, Mat3x4f &result)
+{
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int r = 0; r < 3; ++r)
+        {
+            result.cols[c][r] =
+                a.cols[0][r] * b.cols[c][0] + a.cols[1][r] * b.cols[c][1] + a.cols[2][r] * b.cols[c][2];
+        }
+        result.cols[c][3] = 0;
+    }
+    result.cols[3][0] += a.cols[3][0];
+    result.cols[3][1] += a.cols[3][1];
+    result.cols[3][2] += a.cols[3][2];
+    result.cols[3][3] = 1;
+}
+
+// Products through the kernels of the active instruction set
+void MultiplyDispatch(const Mat4f &a, const Mat4f &b, Mat4f &result);
+void MultiplyDispatch(const Mat4f &a, const Vec4f &v, Vec4f &result);
+void MultiplyDispatch(const Mat3x4f &a, const Mat3x4f &b, Mat3x4f &result);
+
+constexpr Mat4f Mat4f::operator*(const Mat4f &other) const
+{
+    Mat4f result;
+    if (std::is_constant_evaluated())
+        MultiplyScalar(*this, other, result);
+    else
+        MultiplyDispatch(*this, other, result);
+    return result;
+}
+
+constexpr Vec4f Mat4f::operator*(const Vec4f &other) const
+{
+    Vec4f result;
+    if (std::is_constant_evaluated())
+        MultiplyScalar(*this, other, result);
+    else
+        MultiplyDispatch(*this, other, result);
+    return result;
+}
+
+constexpr Mat4f &Mat4f::operator*=(const Mat4f &mat4_f)
+{
+    *this = *this * mat4_f;
+    return *this;
+}
+
+constexpr Mat4f Mat4f::transpose() const
+{
+    Mat4f result{};
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            result.mat[i][j] = mat[j][i];
+        }
+    }
+    return result;
+}
+
+constexpr Mat4f Mat4f::Abs() const
+{
+    Mat4f result{};
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            result.mat[i][j] = constmath::Abs(mat[i][j]);
+        }
+    }
+    return result;
+}
+
+constexpr Mat3x4f Mat4f::ToMat3x4f() const
+{
+    Mat3x4f result{};
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            result.cols[c][r] = mat[r][c];
+        }
+    }
+    return result;
+}
+
+constexpr Mat3x4f Mat3x4f::operator*(const Mat3x4f &other) const
+{
+    Mat3x4f result;
+    if (std::is_constant_evaluated())
+        MultiplyScalar(*this, other, result);
+    else
+        MultiplyDispatch(*this, other, result);
+    return result;
+}
+
+constexpr Mat3x4f &Mat3x4f::operator*=(const Mat3x4f &other)
+{
+    *this = *this * other;
+    return *this;
+}
+
+constexpr Mat3x4f &Mat3x4f::Translate(const float x, const float y, const float z)
+{
+    const Vec3f translation = TransformPoint({x, y, z});
+    cols[3][0] = translation.x;
+    cols[3][1] = translation.y;
+    cols[3][2] = translation.z;
+    return *this;
+}
+
+constexpr Mat3x4f &Mat3x4f::Scale(const float x, const float y, const float z)
+{
+    for (int r = 0; r < 3; ++r)
+    {
+        cols[0][r] *= x;
+        cols[1][r] *= y;
+        cols[2][r] *= z;
+    }
+    return *this;
+}
+
+constexpr Vec3f Mat3x4f::TransformPoint(const Vec3f &point) const
+{
+    return {
+        cols[0][0] * point.x + cols[1][0] * point.y + cols[2][0] * point.z + cols[3][0],
+        cols[0][1] * point.x + cols[1][1] * point.y + cols[2][1] * point.z + cols[3][1],
+        cols[0][2] * point.x + cols[1][2] * point.y + cols[2][2] * point.z + cols[3][2],
+    };
+}
 
-void getCatmullRomPoint(float time, std::vector<Vec3f> points, Vec3f &position, Vec3f &derivative);
+constexpr Vec3f Mat3x4f::TransformDirection(const Vec3f &direction) const
+{
+    return {
+        cols[0][0] * direction.x + cols[1][0] * direction.y + cols[2][0] * direction.z,
+        cols[0][1] * direction.x + cols[1][1] * direction.y + cols[2][1] * direction.z,
+        cols[0][2] * direction.x + cols[1][2] * direction.y + cols[2][2] * direction.z,
+    };
+}
+
+constexpr Mat3x4f Mat3x4f::Abs() const
+{
+    Mat3x4f result{};
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            result.cols[c][r] = constmath::Abs(cols[c][r]);
+        }
+    }
+    return result;
+}
+
+constexpr Mat3x4f Mat3x4f::Inverse() const
+{
+    // Adjugate over the determinant of the linear part, then the translation moved back through it
+    const float(&m)[4][4] = cols;
+    Mat3x4f result{};
+    result.cols[0][0] = m[1][1] * m[2][2] - m[2][1] * m[1][2];
+    result.cols[0][1] = m[2][1] * m[0][2] - m[0][1] * m[2][2];
+    result.cols[0][2] = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+    result.cols[1][0] = m[2][0] * m[1][2] - m[1][0] * m[2][2];
+    result.cols[1][1] = m[0][0] * m[2][2] - m[2][0] * m[0][2];
+    result.cols[1][2] = m[1][0] * m[0][2] - m[0][0] * m[1][2];
+    result.cols[2][0] = m[1][0] * m[2][1] - m[2][0] * m[1][1];
+    result.cols[2][1] = m[2][0] * m[0][1] - m[0][0] * m[2][1];
+    result.cols[2][2] = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+
+    const float inverse_determinant =
+        1.0f / (m[0][0] * result.cols[0][0] + m[1][0] * result.cols[0][1] + m[2][0] * result.cols[0][2]);
+    for (int c = 0; c < 3; ++c)
+    {
+        for (int r = 0; r < 3; ++r)
+        {
+            result.cols[c][r] *= inverse_determinant;
+        }
+    }
+
+    const Vec3f translation = result.TransformDirection(GetTranslation());
+    result.cols[3][0] = -translation.x;
+    result.cols[3][1] = -translation.y;
+    result.cols[3][2] = -translation.z;
+    result.cols[3][3] = 1;
+    return result;
+}
+
+constexpr Mat4f Mat3x4f::ToMat4f() const
+{
+    Mat4f result{};
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int r = 0; r < 4; ++r)
+        {
+            result.mat[r][c] = cols[c][r];
+        }
+    }
+    return result;
+}
+
+constexpr Mat3x4f Mat3x4fTranslate(const float x, const float y, const float z)
+{
+    return {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {x, y, z, 1}}};
+}
+
+constexpr Mat3x4f Mat3x4fScale(const float x, const float y, const float z)
+{
+    return {{{x, 0, 0, 0}, {0, y, 0, 0}, {0, 0, z, 0}, {0, 0, 0, 1}}};
+}
+
+constexpr Mat3x4f Mat3x4fRotate(const float angle, const float x, const float y, const float z)
+{
+    const auto [sina, cosa] = constmath::SinCos(angle);
+
+    return {
+        {{
+             x * x + (1 - x * x) * cosa,
+             x * y * (1 - cosa) + z * sina,
+             x * z * (1 - cosa) - y * sina,
+             0,
+         },
+         {
+             x * y * (1 - cosa) - z * sina,
+             y * y + (1 - y * y) * cosa,
+             y * z * (1 - cosa) + x * sina,
+             0,
+         },
+         {
+             x * z * (1 - cosa) + y * sina,
+             y * z * (1 - cosa) - x * sina,
+             z * z + (1 - z * z) * cosa,
+             0,
+         },
+         {0, 0, 0, 1}}
+    };
+}
+
+constexpr Mat3x4f Mat3x4fFromBasis(const Vec3f &x, const Vec3f &y, const Vec3f &z, const Vec3f &translation)
+{
+    return {
+        {{x.x, x.y, x.z, 0}, {y.x, y.y, y.z, 0}, {z.x, z.y, z.z, 0}, {translation.x, translation.y, translation.z, 1}}
+    };
+}
+
+// Batched versions of Mat3x4f::TransformPoint / TransformDirection. The points are transposed internally into
+// structure-of-arrays form so each SIMD iteration transforms 4 (NEON) or 8 (AVX2) of them at once. SSE4 runs the
+// scalar loop, which the compiler vectorizes better than the transposes.
+// result must have the same size as the input and may be the same span.
+void TransformPoints(const Mat3x4f &matrix, std::span<const Vec3f> points, std::span<Vec3f> result);
+void TransformDirections(const Mat3x4f &matrix, std::span<const Vec3f> directions, std::span<Vec3f> result);
+
+constexpr Mat4f Mat4fTranslate(const float x, const float y, const float z)
+{
+    return {{{1, 0, 0, x}, {0, 1, 0, y}, {0, 0, 1, z}, {0, 0, 0, 1}}};
+}
+
+constexpr Mat4f Mat4fScale(const float x, const float y, const float z)
+{
+    return {{{x, 0, 0, 0}, {0, y, 0, 0}, {0, 0, z, 0}, {0, 0, 0, 1}}};
+}
+
+constexpr Mat4f Mat4fRotate(const float angle, const float x, const float y, const float z)
+{
+    const auto [sina, cosa] = constmath::SinCos(angle);
+
+    return {
+        {{
+             x * x + (1 - x * x) * cosa,
+             x * y * (1 - cosa) - z * sina,
+             x * z * (1 - cosa) + y * sina,
+             0,
+         },
+         {
+             x * y * (1 - cosa) + z * sina,
+             y * y + (1 - y * y) * cosa,
+             y * z * (1 - cosa) - x * sina,
+             0,
+         },
+         {
+             x * z * (1 - cosa) - y * sina,
+             y * z * (1 - cosa) + x * sina,
+             z * z + (1 - z * z) * cosa,
+             0,
+         },
+         {0, 0, 0, 1}}
+    };
+}
+
+constexpr Mat4f Mat4fRotateX(const float angle)
+{
+    const auto [s, c] = constmath::SinCos(angle);
+    return {{{1, 0, 0, 0}, {0, c, -s, 0}, {0, s, c, 0}, {0, 0, 0, 1}}};
+}
+
+constexpr Mat4f Mat4fRotateY(const float angle)
+{
+    const auto [s, c] = constmath::SinCos(angle);
+    return {{{c, 0, s, 0}, {0, 1, 0, 0}, {-s, 0, c, 0}, {0, 0, 0, 1}}};
+}
+
+constexpr Mat4f Mat4fRotateZ(const float angle)
+{
+    const auto [s, c] = constmath::SinCos(angle);
+    return {{{c, -s, 0, 0}, {s, c, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
+}
 
 // Predefined matrices
 constexpr Mat4f Mat4fIdentity = {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
-constexpr Mat4f Mat4fRotateX_M_PI = {{{1, 0, 0, 0}, {0, -1, 0, 0}, {0, 0, -1, 0}, {0, 0, 0, 1}}};
-constexpr Mat4f Mat4fRotateX_M_PI_2 = {{{1, 0, 0, 0}, {0, 0, -1, 0}, {0, 1, 0, 0}, {0, 0, 0, 1}}};
-constexpr Mat4f Mat4fRotateX_NEGATIVE_M_PI_2 = {{{1, 0, 0, 0}, {0, 0, 1, 0}, {0, -1, 0, 0}, {0, 0, 0, 1}}};
-constexpr Mat4f Mat4fRotateY_M_PI = {{{-1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, -1, 0}, {0, 0, 0, 1}}};
-constexpr Mat4f Mat4fRotateY_M_PI_2 = {{{0, 0, 1, 0}, {0, 1, 0, 0}, {-1, 0, 0, 0}, {0, 0, 0, 1}}};
-constexpr Mat4f Mat4fRotateY_NEGATIVE_M_PI_2 = {{{0, 0, -1, 0}, {0, 1, 0, 0}, {1, 0, 0, 0}, {0, 0, 0, 1}}};
-constexpr Mat4f Mat4fRotateZ_M_PI_2 = {{{0, -1, 0, 0}, {1, 0, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
-constexpr Mat4f Mat4fRotateZ_NEGATIVE_M_PI_2 = {{{0, 1, 0, 0}, {-1, 0, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
+constexpr Mat3x4f Mat3x4fIdentity = {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}};
+constexpr Mat4f Mat4fRotateX_M_PI = Mat4fRotateX(M_PI);
+constexpr Mat4f Mat4fRotateX_M_PI_2 = Mat4fRotateX(M_PI_2);
+constexpr Mat4f Mat4fRotateX_NEGATIVE_M_PI_2 = Mat4fRotateX(-M_PI_2);
+constexpr Mat4f Mat4fRotateY_M_PI = Mat4fRotateY(M_PI);
+constexpr Mat4f Mat4fRotateY_M_PI_2 = Mat4fRotateY(M_PI_2);
+constexpr Mat4f Mat4fRotateY_NEGATIVE_M_PI_2 = Mat4fRotateY(-M_PI_2);
+constexpr Mat4f Mat4fRotateZ_M_PI_2 = Mat4fRotateZ(M_PI_2);
+constexpr Mat4f Mat4fRotateZ_NEGATIVE_M_PI_2 = Mat4fRotateZ(-M_PI_2);
 
 #endif // MAT_H
@@ -0,0 +1,137 @@
+#ifndef QUAT_H
+#define QUAT_H
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include "ConstexprMath.h"
+#include "Mat.h"
+#include "Vec.h"
+
+// Rotation as a unit quaternion w + xi + yj + zk. Composing two of them costs 16 multiplications and they can be
+// interpolated, the matrix is only built at the end with ToMat3x4f.
+struct Quatf
+{
+    float w = 1, x = 0, y = 0, z = 0;
+
+    // Hamilton product, applies other first and then this
+    constexpr Quatf operator*(const Quatf &other) const
+    {
+        return {
+            w * other.w - x * other.x - y * other.y - z * other.z,
+            w * other.x + x * other.w + y * other.z - z * other.y,
+            w * other.y - x * other.z + y * other.w + z * other.x,
+            w * other.z + x * other.y - y * other.x + z * other.w,
+        };
+    }
+    constexpr Quatf operator+(const Quatf &other) const
+    {
+        return {w + other.w, x + other.x, y + other.y, z + other.z};
+    }
+    constexpr Quatf operator*(const float scalar) const { return {w * scalar, x * scalar, y * scalar, z * scalar}; }
+    constexpr Quatf operator-() const { return {-w, -x, -y, -z}; }
+    constexpr float Dot(const Quatf &other) const { return w * other.w + x * other.x + y * other.y + z * other.z; }
+    constexpr Quatf Conjugate() const { return {w, -x, -y, -z}; }
+
+    Quatf Normalize() const
+    {
+        const float length = sqrtf(Dot(*this));
+        if (length == 0)
+        {
+            return {};
+        }
+        return *this * (1.0f / length);
+    }
+
+    constexpr Mat3x4f ToMat3x4f() const
+    {
+        const float xx = x * x, yy = y * y, zz = z * z;
+        const float xy = x * y, xz = x * z, yz = y * z;
+        const float wx = w * x, wy = w * y, wz = w * z;
+
+        return {
+            {{1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy), 0},
+             {2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx), 0},
+             {2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy), 0},
+             {0, 0, 0, 1}}
+        };
+    }
+};
+
+// The axis doesn't need to be normalized. A zero axis gives the identity.
+inline Quatf QuatfFromAxisAngle(const float angle, const Vec3f &axis)
+{
+    const Vec3f unit_axis = axis.Normalize();
+    const auto [sin_half, cos_half] = constmath::SinCos(angle * 0.5f);
+    return {cos_half, unit_axis.x * sin_half, unit_axis.y * sin_half, unit_axis.z * sin_half};
+}
+
+// Rotation of angle radians around a unit axis for small angles (|angle| <= QUATF_SMALL_ANGLE) without any
+// trigonometry: the half angle sin/cos are replaced by their Taylor polynomials, which for |angle / 2| <= 0.1 are
+// exact to float precision. Meant for advancing an existing rotation every frame.
+constexpr float QUATF_SMALL_ANGLE = 0.2f;
+
+constexpr Quatf QuatfFromSmallAngle(const float angle, const Vec3f &unit_axis)
+{
+    const float h = angle * 0.5f;
+    const float h2 = h * h;
+    const float sin_half = h * (1 - h2 / 6 * (1 - h2 / 20));
+    const float cos_half = 1 - h2 / 2 * (1 - h2 / 12 * (1 - h2 / 30));
+    return {cos_half, unit_axis.x * sin_half, unit_axis.y * sin_half, unit_axis.z * sin_half};
+}
+
+// Rotation of a matrix whose first three columns are orthonormal, with a positive determinant (Shepperd's method,
+// which takes the square root of the largest of w, x, y and z so it never divides by ~0)
+inline Quatf QuatfFromMat3x4f(const Mat3x4f &rotation)
+{
+    const auto m = [&rotation](const int row, const int column) { return rotation.cols[column][row]; };
+    const float trace = m(0, 0) + m(1, 1) + m(2, 2);
+
+    if (trace > 0)
+    {
+        const float s = sqrtf(trace + 1) * 2;
+        return {s / 4, (m(2, 1) - m(1, 2)) / s, (m(0, 2) - m(2, 0)) / s, (m(1, 0) - m(0, 1)) / s};
+    }
+    if (m(0, 0) > m(1, 1) && m(0, 0) > m(2, 2))
+    {
+        const float s = sqrtf(1 + m(0, 0) - m(1, 1) - m(2, 2)) * 2;
+        return {(m(2, 1) - m(1, 2)) / s, s / 4, (m(0, 1) + m(1, 0)) / s, (m(0, 2) + m(2, 0)) / s};
+    }
+    if (m(1, 1) > m(2, 2))
+    {
+        const float s = sqrtf(1 + m(1, 1) - m(0, 0) - m(2, 2)) * 2;
+        return {(m(0, 2) - m(2, 0)) / s, (m(0, 1) + m(1, 0)) / s, s / 4, (m(1, 2) + m(2, 1)) / s};
+    }
+    const float s = sqrtf(1 + m(2, 2) - m(0, 0) - m(1, 1)) * 2;
+    return {(m(1, 0) - m(0, 1)) / s, (m(0, 2) + m(2, 0)) / s, (m(1, 2) + m(2, 1)) / s, s / 4};
+}
+
+// Normalized linear interpolation through the shortest path. Not constant speed, but cheap and good enough for
+// close rotations.
+inline Quatf QuatfNlerp(const Quatf &a, const Quatf &b, const float t)
+{
+    const Quatf target = a.Dot(b) < 0 ? -b : b;
+    return (a * (1 - t) + target * t).Normalize();
+}
+
+// Spherical linear interpolation through the shortest path, constant angular speed
+inline Quatf QuatfSlerp(const Quatf &a, const Quatf &b, const float t)
+{
+    float cos_theta = a.Dot(b);
+    const Quatf target = cos_theta < 0 ? -b : b;
+    cos_theta = fabsf(cos_theta);
+
+    // Almost the same rotation, sin(theta) would divide by ~0
+    if (cos_theta > 0.9995f)
+    {
+        return QuatfNlerp(a, target, t);
+    }
+
+    const float theta = acosf(cos_theta);
+    const float sin_theta = sinf(theta);
+    const float weight_a = sinf((1 - t) * theta) / sin_theta;
+    const float weight_b = sinf(t * theta) / sin_theta;
+    return a * weight_a + target * weight_b;
+}
+
+#endif // QUAT_H
@@ -0,0 +1,113 @@
+#include "Simd.h"
+
+#include <initializer_list>
+
+#if defined(SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace simd
+{
+#ifdef SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    bool cpuHasSse4()
+    {
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 19)) != 0; // SSE4.1
+    }
+
+    bool cpuHasAvx2()
+    {
+        int info[4];
+        __cpuid(info, 1);
+        const bool has_fma = (info[2] & (1 << 12)) != 0;
+        const bool has_osxsave = (info[2] & (1 << 27)) != 0;
+        if (!has_fma || !has_osxsave)
+            return false;
+
+        // The OS needs to save the YMM registers on context switches
+        if ((_xgetbv(0) & 0x6) != 0x6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }
+#else
+    bool cpuHasSse4() { return __builtin_cpu_supports("sse4.1"); }
+
+    bool cpuHasAvx2() { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+#endif
+#endif
+
+    bool IsSupported(const InstructionSet set)
+    {
+        switch (set)
+        {
+            case InstructionSet::SCALAR:
+                return true;
+#ifdef SIMD_X86
+            case InstructionSet::SSE4:
+                {
+                    static const bool supported = cpuHasSse4();
+                    return supported;
+                }
+            case InstructionSet::AVX2:
+                {
+                    static const bool supported = cpuHasAvx2();
+                    return supported;
+                }
+#endif
+#ifdef SIMD_NEON
+            case InstructionSet::NEON:
+                return true;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    InstructionSet GetBestSupported()
+    {
+        for (const auto set : {InstructionSet::AVX2, InstructionSet::SSE4, InstructionSet::NEON})
+        {
+            if (IsSupported(set))
+                return set;
+        }
+        return InstructionSet::SCALAR;
+    }
+
+    InstructionSet &activeInstructionSet()
+    {
+        static InstructionSet active = GetBestSupported();
+        return active;
+    }
+
+    InstructionSet GetActive() { return activeInstructionSet(); }
+
+    bool SetActive(const InstructionSet set)
+    {
+        if (!IsSupported(set))
+            return false;
+
+        activeInstructionSet() = set;
+        return true;
+    }
+
+    const char *GetName(const InstructionSet set)
+    {
+        switch (set)
+        {
+            case InstructionSet::SCALAR:
+                return "Scalar";
+            case InstructionSet::SSE4:
+                return "SSE4";
+            case InstructionSet::AVX2:
+                return "AVX2";
+            case InstructionSet::NEON:
+                return "NEON";
+            default:
+                return "Unknown";
+        }
+    }
+} // namespace simd
@@ -0,0 +1,43 @@
+#ifndef CG_SOLAR_SYSTEM_SIMD_H
+#define CG_SOLAR_SYSTEM_SIMD_H
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define SIMD_NEON 1
+#endif
+
+// Kernels for instruction sets above the compiler baseline are compiled with a per-function target so the rest of
+// the program keeps running on CPUs without them. MSVC allows intrinsics without any flag.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SIMD_TARGET(isa)
+#else
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace simd
+{
+    enum class InstructionSet
+    {
+        SCALAR,
+        SSE4,
+        AVX2, // AVX2 + FMA
+        NEON,
+        COUNT
+    };
+
+    bool IsSupported(InstructionSet set);
+
+    // Best instruction set supported by the running CPU, detected once at startup
+    InstructionSet GetBestSupported();
+
+    // Instruction set currently used by the math kernels (defaults to the best supported one)
+    InstructionSet GetActive();
+
+    // Forces the kernels to a specific instruction set. Returns false if the CPU doesn't support it.
+    bool SetActive(InstructionSet set);
+
+    const char *GetName(InstructionSet set);
+} // namespace simd
+
+#endif // CG_SOLAR_SYSTEM_SIMD_H
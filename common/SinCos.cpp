@@ -0,0 +1,212 @@
+#include "SinCos.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include "Simd.h"
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+#ifdef SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    constexpr float TWO_OVER_PI = 0.636619772367581343f;
+
+    // pi/2 = PIO2_1 + PIO2_2 + PIO2_3, the first two have enough trailing zero bits that multiplying them by the
+    // quarter turn count is exact for |angle| <= SINCOS_MAX_ANGLE
+    constexpr float PIO2_1 = 1.5703125f;
+    constexpr float PIO2_2 = 4.837512969970703125e-4f;
+    constexpr float PIO2_3 = 7.54978995489188216e-8f;
+
+    // Cephes minimax polynomials for [-pi/4, pi/4]
+    constexpr float SIN_1 = -1.6666654611e-1f;
+    constexpr float SIN_2 = 8.3321608736e-3f;
+    constexpr float SIN_3 = -1.9515295891e-4f;
+    constexpr float COS_1 = 4.166664568298827e-2f;
+    constexpr float COS_2 = -1.388731625493765e-3f;
+    constexpr float COS_3 = 2.443315711809948e-5f;
+
+    // Reference implementation, the SSE4 and NEON kernels do the same operations in the same order
+    void sinCosScalar(const float *angles, float *sines, float *cosines, const size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float angle = angles[i];
+            const float quarters = nearbyintf(angle * TWO_OVER_PI);
+            const int quadrant = static_cast<int>(quarters);
+
+            const float r = ((angle - quarters * PIO2_1) - quarters * PIO2_2) - quarters * PIO2_3;
+            const float z = r * r;
+            const float s = r + r * z * (SIN_1 + z * (SIN_2 + z * SIN_3));
+            const float c = 1 - 0.5f * z + z * z * (COS_1 + z * (COS_2 + z * COS_3));
+
+            // Odd quadrants swap sin and cos, the signs follow the quadrant of the original angle
+            const float sin_value = (quadrant & 1) ? c : s;
+            const float cos_value = (quadrant & 1) ? s : c;
+            sines[i] = (quadrant & 2) ? -sin_value : sin_value;
+            cosines[i] = ((quadrant + 1) & 2) ? -cos_value : cos_value;
+        }
+    }
+
+#ifdef SIMD_X86
+    SIMD_TARGET("sse4.1") void sinCosSse4(const float *angles, float *sines, float *cosines, const size_t count)
+    {
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i two = _mm_set1_epi32(2);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 angle = _mm_loadu_ps(angles + i);
+            const __m128 quarters = _mm_round_ps(
+                _mm_mul_ps(angle, _mm_set1_ps(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC
+            );
+            const __m128i quadrant = _mm_cvtps_epi32(quarters);
+
+            __m128 r = _mm_sub_ps(angle, _mm_mul_ps(quarters, _mm_set1_ps(PIO2_1)));
+            r = _mm_sub_ps(r, _mm_mul_ps(quarters, _mm_set1_ps(PIO2_2)));
+            r = _mm_sub_ps(r, _mm_mul_ps(quarters, _mm_set1_ps(PIO2_3)));
+            const __m128 z = _mm_mul_ps(r, r);
+
+            __m128 s = _mm_add_ps(_mm_set1_ps(SIN_2), _mm_mul_ps(z, _mm_set1_ps(SIN_3)));
+            s = _mm_add_ps(_mm_set1_ps(SIN_1), _mm_mul_ps(z, s));
+            s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, z), s));
+
+            __m128 c = _mm_add_ps(_mm_set1_ps(COS_2), _mm_mul_ps(z, _mm_set1_ps(COS_3)));
+            c = _mm_add_ps(_mm_set1_ps(COS_1), _mm_mul_ps(z, c));
+            c = _mm_add_ps(
+                _mm_sub_ps(_mm_set1_ps(1), _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_mul_ps(_mm_mul_ps(z, z), c)
+            );
+
+            const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+            const __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+            const __m128 cos_sign =
+                _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+
+            _mm_storeu_ps(sines + i, _mm_xor_ps(_mm_blendv_ps(s, c, swap), sin_sign));
+            _mm_storeu_ps(cosines + i, _mm_xor_ps(_mm_blendv_ps(c, s, swap), cos_sign));
+        }
+
+        sinCosScalar(angles + i, sines + i, cosines + i, count - i);
+    }
+
+    // Same as the SSE4 kernel with 8 lanes, the reduction and polynomials use FMA
+    SIMD_TARGET("avx2,fma") void sinCosAvx2(const float *angles, float *sines, float *cosines, const size_t count)
+    {
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i two = _mm256_set1_epi32(2);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 angle = _mm256_loadu_ps(angles + i);
+            const __m256 quarters = _mm256_round_ps(
+                _mm256_mul_ps(angle, _mm256_set1_ps(TWO_OVER_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC
+            );
+            const __m256i quadrant = _mm256_cvtps_epi32(quarters);
+
+            __m256 r = _mm256_fnmadd_ps(quarters, _mm256_set1_ps(PIO2_1), angle);
+            r = _mm256_fnmadd_ps(quarters, _mm256_set1_ps(PIO2_2), r);
+            r = _mm256_fnmadd_ps(quarters, _mm256_set1_ps(PIO2_3), r);
+            const __m256 z = _mm256_mul_ps(r, r);
+
+            __m256 s = _mm256_fmadd_ps(z, _mm256_set1_ps(SIN_3), _mm256_set1_ps(SIN_2));
+            s = _mm256_fmadd_ps(z, s, _mm256_set1_ps(SIN_1));
+            s = _mm256_fmadd_ps(_mm256_mul_ps(r, z), s, r);
+
+            __m256 c = _mm256_fmadd_ps(z, _mm256_set1_ps(COS_3), _mm256_set1_ps(COS_2));
+            c = _mm256_fmadd_ps(z, c, _mm256_set1_ps(COS_1));
+            c = _mm256_fmadd_ps(_mm256_mul_ps(z, z), c, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, _mm256_set1_ps(1)));
+
+            const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+            const __m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+            const __m256 cos_sign =
+                _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+
+            _mm256_storeu_ps(sines + i, _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sin_sign));
+            _mm256_storeu_ps(cosines + i, _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cos_sign));
+        }
+
+        sinCosSse4(angles + i, sines + i, cosines + i, count - i);
+    }
+#endif
+
+#ifdef SIMD_NEON
+    void sinCosNeon(const float *angles, float *sines, float *cosines, const size_t count)
+    {
+        const int32x4_t one = vdupq_n_s32(1);
+        const int32x4_t two = vdupq_n_s32(2);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const float32x4_t angle = vld1q_f32(angles + i);
+            const float32x4_t quarters = vrndnq_f32(vmulq_n_f32(angle, TWO_OVER_PI));
+            const int32x4_t quadrant = vcvtq_s32_f32(quarters);
+
+            float32x4_t r = vsubq_f32(angle, vmulq_n_f32(quarters, PIO2_1));
+            r = vsubq_f32(r, vmulq_n_f32(quarters, PIO2_2));
+            r = vsubq_f32(r, vmulq_n_f32(quarters, PIO2_3));
+            const float32x4_t z = vmulq_f32(r, r);
+
+            float32x4_t s = vaddq_f32(vdupq_n_f32(SIN_2), vmulq_n_f32(z, SIN_3));
+            s = vaddq_f32(vdupq_n_f32(SIN_1), vmulq_f32(z, s));
+            s = vaddq_f32(r, vmulq_f32(vmulq_f32(r, z), s));
+
+            float32x4_t c = vaddq_f32(vdupq_n_f32(COS_2), vmulq_n_f32(z, COS_3));
+            c = vaddq_f32(vdupq_n_f32(COS_1), vmulq_f32(z, c));
+            c = vaddq_f32(vsubq_f32(vdupq_n_f32(1), vmulq_n_f32(z, 0.5f)), vmulq_f32(vmulq_f32(z, z), c));
+
+            const uint32x4_t swap = vceqq_s32(vandq_s32(quadrant, one), one);
+            const uint32x4_t sin_sign = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(quadrant, two), 30));
+            const uint32x4_t cos_sign =
+                vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(vaddq_s32(quadrant, one), two), 30));
+
+            const uint32x4_t sin_value = vreinterpretq_u32_f32(vbslq_f32(swap, c, s));
+            const uint32x4_t cos_value = vreinterpretq_u32_f32(vbslq_f32(swap, s, c));
+            vst1q_f32(sines + i, vreinterpretq_f32_u32(veorq_u32(sin_value, sin_sign)));
+            vst1q_f32(cosines + i, vreinterpretq_f32_u32(veorq_u32(cos_value, cos_sign)));
+        }
+
+        sinCosScalar(angles + i, sines + i, cosines + i, count - i);
+    }
+#endif
+
+    using SinCosKernel = void (*)(const float *, float *, float *, size_t);
+
+    // Indexed by simd::InstructionSet, instruction sets not available in this architecture fall back to scalar
+    constexpr SinCosKernel SINCOS_KERNELS[static_cast<int>(simd::InstructionSet::COUNT)] = {
+        sinCosScalar,
+#ifdef SIMD_X86
+        sinCosSse4,
+        sinCosAvx2,
+#else
+        sinCosScalar,
+        sinCosScalar,
+#endif
+#ifdef SIMD_NEON
+        sinCosNeon,
+#else
+        sinCosScalar,
+#endif
+    };
+} // namespace
+
+void SinCosBatch(const std::span<const float> angles, const std::span<float> sines, const std::span<float> cosines)
+{
+    SINCOS_KERNELS[static_cast<int>(simd::GetActive())](angles.data(), sines.data(), cosines.data(), angles.size());
+}
+
+void SinCosRing(const double start, const double step, const std::span<float> sines, const std::span<float> cosines)
+{
+    // The angles go through the sines array, every kernel loads a block of angles before storing its results
+    for (size_t i = 0; i < sines.size(); ++i)
+    {
+        sines[i] = static_cast<float>(start + static_cast<double>(i) * step);
+    }
+    SinCosBatch(sines, sines, cosines);
+}
@@ -0,0 +1,23 @@
+#ifndef CG_SOLAR_SYSTEM_SINCOS_H
+#define CG_SOLAR_SYSTEM_SINCOS_H
+
+#include <cstddef>
+#include <span>
+
+// Batched sin/cos through the SIMD kernels of simd::GetActive(), 4 (SSE4, NEON) or 8 (AVX2) angles per iteration.
+// The angle is reduced to [-pi/4, pi/4] by quarter turns (Cody-Waite, pi/2 split in three floats) and evaluated with
+// the Cephes minimax polynomials. Every instruction set gives the same results except AVX2, which uses FMA.
+//
+// Maximum error against the correctly rounded result, measured over |angle| <= 8192 (see cg-bench-math): 2 ulp when
+// the result is above 2^-10 in magnitude, and 2^-33 absolute error closer to the zeros of the function.
+// Precision degrades for larger angles, where the quarter turn count no longer fits the reduction constants.
+constexpr float SINCOS_MAX_ANGLE = 8192.0f;
+
+// sines and cosines must have the same size as angles
+void SinCosBatch(std::span<const float> angles, std::span<float> sines, std::span<float> cosines);
+
+// sin/cos of start + i * step for every i in [0, sines.size()), the angles of a ring of vertices.
+// The angles are accumulated in double so they match start + i * step evaluated in double by the caller.
+void SinCosRing(double start, double step, std::span<float> sines, std::span<float> cosines);
+
+#endif // CG_SOLAR_SYSTEM_SINCOS_H
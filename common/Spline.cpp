@@ -0,0 +1,185 @@
+#include "Spline.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace
+{
+    // Segment of a closed loop of count segments and the time inside it
+    size_t locateSegment(const float time, const size_t count, float &segment_time)
+    {
+        // Wrapping the time first is exact and avoids an integer modulo
+        const float loop_time = (time - floorf(time)) * static_cast<float>(count);
+        const size_t index = std::min(static_cast<size_t>(loop_time), count - 1);
+        segment_time = loop_time - static_cast<float>(index);
+        return index;
+    }
+
+    // Spline parameter at evenly spaced arc lengths. The length is integrated with chords between fine samples and
+    // inverted by walking both sequences once.
+    std::vector<float> buildArcLengthTable(const std::vector<SplineSegment> &segments)
+    {
+        const size_t entries = segments.size() * ARC_LENGTH_ENTRIES_PER_SEGMENT;
+        const size_t steps_per_segment = ARC_LENGTH_ENTRIES_PER_SEGMENT * ARC_LENGTH_STEPS_PER_ENTRY;
+
+        std::vector<double> lengths; // arc length at the start of every step, and the total length at the end
+        lengths.reserve(segments.size() * steps_per_segment + 1);
+        double length = 0;
+        for (const auto &segment : segments)
+        {
+            Vec3f previous = segment.d;
+            for (size_t step = 1; step <= steps_per_segment; ++step)
+            {
+                lengths.push_back(length);
+                const Vec3f position = segment.Position(static_cast<float>(step) / steps_per_segment);
+                length += (position - previous).Length();
+                previous = position;
+            }
+        }
+        lengths.push_back(length);
+
+        if (length <= 0)
+            return {};
+
+        std::vector<float> table(entries + 1);
+        size_t step = 0;
+        for (size_t entry = 0; entry < entries; ++entry)
+        {
+            const double target = length * static_cast<double>(entry) / static_cast<double>(entries);
+            while (lengths[step + 1] < target)
+                ++step;
+
+            const double step_length = lengths[step + 1] - lengths[step];
+            const double step_fraction = step_length > 0 ? (target - lengths[step]) / step_length : 0;
+            table[entry] = static_cast<float>((static_cast<double>(step) + step_fraction) / steps_per_segment);
+        }
+        table[entries] = static_cast<float>(segments.size());
+        return table;
+    }
+} // namespace
+
+SplineSegment CatmullRomSegment(const Vec3f &p0, const Vec3f &p1, const Vec3f &p2, const Vec3f &p3)
+{
+    return {
+        p0 * -0.5f + p1 * 1.5f + p2 * -1.5f + p3 * 0.5f,
+        p0 + p1 * -2.5f + p2 * 2.0f + p3 * -0.5f,
+        p0 * -0.5f + p2 * 0.5f,
+        p1,
+    };
+}
+
+void CatmullRomSpline::Build(const std::span<const Vec3f> points, const bool constant_speed)
+{
+    const size_t count = points.size();
+    m_segments.clear();
+    m_segments.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_segments.push_back(CatmullRomSegment(
+            points[(i + count - 1) % count], points[i], points[(i + 1) % count], points[(i + 2) % count]
+        ));
+    }
+
+    m_arc_length_table.clear();
+    if (constant_speed && count > 0)
+        m_arc_length_table = buildArcLengthTable(m_segments);
+}
+
+void CatmullRomSpline::Evaluate(const float time, Vec3f &position, Vec3f &derivative) const
+{
+    float segment_time;
+    size_t index;
+    if (m_arc_length_table.empty())
+    {
+        index = locateSegment(time, m_segments.size(), segment_time);
+    }
+    else
+    {
+        // Indexing the table directly and interpolating between two entries gives the segment index and time
+        float entry_time;
+        const size_t entry = locateSegment(time, m_arc_length_table.size() - 1, entry_time);
+        const float parameter =
+            m_arc_length_table[entry] + (m_arc_length_table[entry + 1] - m_arc_length_table[entry]) * entry_time;
+        index = std::min(static_cast<size_t>(parameter), m_segments.size() - 1);
+        segment_time = parameter - static_cast<float>(index);
+    }
+
+    const auto &segment = m_segments[index];
+    position = segment.Position(segment_time);
+    derivative = segment.Derivative(segment_time);
+}
+
+void RotationMinimizingFrames::Build(const CatmullRomSpline &spline, const Vec3f &initial_up)
+{
+    m_up_vectors.clear();
+    if (spline.Empty())
+        return;
+
+    const size_t count = spline.GetSegments().size() * FRAMES_PER_SEGMENT;
+    std::vector<Vec3f> positions(count + 1), tangents(count + 1);
+    for (size_t i = 0; i <= count; ++i)
+    {
+        Vec3f derivative;
+        spline.Evaluate(static_cast<float>(i) / static_cast<float>(count), positions[i], derivative);
+        tangents[i] = derivative.Normalize();
+    }
+
+    m_up_vectors.resize(count + 1);
+    m_up_vectors[0] = tangents[0].Cross(initial_up).Cross(tangents[0]).Normalize();
+    if (m_up_vectors[0].Length() == 0)
+        m_up_vectors[0] = tangents[0].Cross(Vec3f{1, 0, 0}).Cross(tangents[0]).Normalize();
+
+    // Double reflection (Wang et al. 2008): reflect the frame across the plane between the two points, then across
+    // the one that takes the reflected tangent to the next tangent
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Vec3f &up = m_up_vectors[i];
+        const Vec3f step = positions[i + 1] - positions[i];
+        const float step_length2 = step.Dot(step);
+        if (step_length2 == 0)
+        {
+            m_up_vectors[i + 1] = up;
+            continue;
+        }
+
+        const Vec3f reflected_up = up - step * (2 / step_length2 * step.Dot(up));
+        const Vec3f reflected_tangent = tangents[i] - step * (2 / step_length2 * step.Dot(tangents[i]));
+        const Vec3f correction = tangents[i + 1] - reflected_tangent;
+        const float correction_length2 = correction.Dot(correction);
+        m_up_vectors[i + 1] = reflected_up;
+        if (correction_length2 != 0)
+            m_up_vectors[i + 1] -= correction * (2 / correction_length2 * correction.Dot(reflected_up));
+    }
+
+    // Untwist every frame by its share of the angle between the last frame and the first one
+    const float twist = atan2f(
+        m_up_vectors[0].Cross(m_up_vectors[count]).Dot(tangents[0]), m_up_vectors[0].Dot(m_up_vectors[count])
+    );
+    for (size_t i = 1; i < count; ++i)
+    {
+        const float angle = -twist * static_cast<float>(i) / static_cast<float>(count);
+        const Vec3f &up = m_up_vectors[i];
+        m_up_vectors[i] = (up * cosf(angle) + tangents[i].Cross(up) * sinf(angle)).Normalize();
+    }
+    m_up_vectors[count] = m_up_vectors[0];
+}
+
+Vec3f RotationMinimizingFrames::GetUp(const float time) const
+{
+    float frame_time;
+    const size_t index = locateSegment(time, m_up_vectors.size() - 1, frame_time);
+    return m_up_vectors[index] + (m_up_vectors[index + 1] - m_up_vectors[index]) * frame_time;
+}
+
+void getCatmullRomPoint(const float time, const std::vector<Vec3f> &points, Vec3f &position, Vec3f &derivative)
+{
+    const size_t count = points.size();
+    float segment_time;
+    const size_t index = locateSegment(time, count, segment_time);
+
+    const auto segment = CatmullRomSegment(
+        points[(index + count - 1) % count], points[index], points[(index + 1) % count], points[(index + 2) % count]
+    );
+    position = segment.Position(segment_time);
+    derivative = segment.Derivative(segment_time);
+}
@@ -0,0 +1,77 @@
+#ifndef CG_SOLAR_SYSTEM_SPLINE_H
+#define CG_SOLAR_SYSTEM_SPLINE_H
+
+#include <span>
+#include <vector>
+
+#include "Vec.h"
+
+// Cubic polynomial of one spline segment, position(t) = a t^3 + b t^2 + c t + d for t in [0, 1]
+struct SplineSegment
+{
+    Vec3f a, b, c, d;
+
+    Vec3f Position(const float t) const { return ((a * t + b) * t + c) * t + d; }
+    Vec3f Derivative(const float t) const { return (a * (3 * t) + b * 2) * t + c; }
+};
+
+// Catmull-Rom segment between p1 and p2, the same as multiplying the Catmull-Rom basis matrix by the points
+SplineSegment CatmullRomSegment(const Vec3f &p0, const Vec3f &p1, const Vec3f &p2, const Vec3f &p3);
+
+// Entries of the arc length table per segment, and the integration steps between two entries
+constexpr size_t ARC_LENGTH_ENTRIES_PER_SEGMENT = 32;
+constexpr size_t ARC_LENGTH_STEPS_PER_ENTRY = 4;
+
+// Closed Catmull-Rom loop through a list of points, with the coefficients of every segment computed once so
+// evaluating it is a Horner step without allocations
+class CatmullRomSpline
+{
+    std::vector<SplineSegment> m_segments;
+    // Spline parameter (segment index + segment time) at evenly spaced arc lengths, with the first entry repeated at
+    // the end. Empty unless the spline moves at constant speed.
+    std::vector<float> m_arc_length_table;
+
+public:
+    CatmullRomSpline() = default;
+    explicit CatmullRomSpline(std::span<const Vec3f> points, bool constant_speed = false)
+    {
+        Build(points, constant_speed);
+    }
+
+    // With constant_speed time is mapped to the distance travelled along the loop instead of spread evenly per
+    // segment, so uneven point spacing doesn't speed up or slow down the motion
+    void Build(std::span<const Vec3f> points, bool constant_speed = false);
+    bool Empty() const { return m_segments.empty(); }
+    bool IsConstantSpeed() const { return !m_arc_length_table.empty(); }
+    const std::vector<SplineSegment> &GetSegments() const { return m_segments; }
+    const std::vector<float> &GetArcLengthTable() const { return m_arc_length_table; }
+
+    // time in [0, 1[ goes through the whole loop once, other values wrap around
+    void Evaluate(float time, Vec3f &position, Vec3f &derivative) const;
+};
+
+// Frames per segment of RotationMinimizingFrames, the up vector is interpolated between them
+constexpr size_t FRAMES_PER_SEGMENT = 16;
+
+// Up vectors of rotation minimizing frames along a closed spline, at evenly spaced times of
+// CatmullRomSpline::Evaluate. They are built once with the double reflection method, so the frame at a time doesn't
+// depend on the times evaluated before it. A loop generally comes back twisted around its direction, the twist is
+// spread evenly over it so the frames still match where it closes.
+class RotationMinimizingFrames
+{
+    std::vector<Vec3f> m_up_vectors; // with the first one repeated at the end
+
+public:
+    // The first frame is the one closest to initial_up
+    void Build(const CatmullRomSpline &spline, const Vec3f &initial_up = {0, 1, 0});
+    bool Empty() const { return m_up_vectors.empty(); }
+
+    // time wraps like in CatmullRomSpline::Evaluate. The up vector is interpolated, so it is only close to
+    // perpendicular to the direction of the spline at time.
+    Vec3f GetUp(float time) const;
+};
+
+// Evaluates the loop without caching the segments
+void getCatmullRomPoint(float time, const std::vector<Vec3f> &points, Vec3f &position, Vec3f &derivative);
+
+#endif // CG_SOLAR_SYSTEM_SPLINE_H
@@ -0,0 +1,410 @@
+#include "SplineBatch.h"
+
+#include <algorithm>
+#include <math.h>
+
+#include "Simd.h"
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+#ifdef SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+    constexpr int32_t SEGMENT_STRIDE = 16; // floats of SplineBatch::SegmentCoefficients
+
+    struct BatchView
+    {
+        const float *segments; // SEGMENT_STRIDE floats per segment
+        const float *tables;
+        const int32_t *segment_offsets;
+        const int32_t *segment_counts;
+        const int32_t *table_offsets;
+        const int32_t *table_entries;
+        const float *periods;
+        float *results[6];
+    };
+
+    // Reference implementation, the same operations as CatmullRomSpline::Evaluate. The SSE4 and NEON kernels do them
+    // in the same order. Indexes are clamped so a zero period (NaN time) can't read outside the arrays.
+    void evaluateScalar(const BatchView &batch, const float time, const size_t begin, const size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const float path_time = time / batch.periods[i];
+            const float loop_time = (path_time - floorf(path_time)) * static_cast<float>(batch.table_entries[i]);
+            const int32_t entry = std::clamp(static_cast<int32_t>(loop_time), 0, batch.table_entries[i] - 1);
+            const float entry_time = loop_time - static_cast<float>(entry);
+
+            const float *table = batch.tables + batch.table_offsets[i] + entry;
+            const float parameter = table[0] + (table[1] - table[0]) * entry_time;
+            const int32_t segment = std::clamp(static_cast<int32_t>(parameter), 0, batch.segment_counts[i] - 1);
+            const float t = parameter - static_cast<float>(segment);
+
+            const float *coefficients = batch.segments + (batch.segment_offsets[i] + segment) * SEGMENT_STRIDE;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float a = coefficients[axis];
+                const float b = coefficients[3 + axis];
+                const float c = coefficients[6 + axis];
+                const float d = coefficients[9 + axis];
+                batch.results[axis][i] = ((a * t + b) * t + c) * t + d;
+                batch.results[3 + axis][i] = (a * (3 * t) + b * 2) * t + c;
+            }
+        }
+    }
+
+#ifdef SIMD_X86
+    // No gather instruction before AVX2, the lanes are loaded one by one
+    SIMD_TARGET("sse4.1") inline __m128 gatherSse4(const float *base, const __m128i index)
+    {
+        return _mm_setr_ps(
+            base[_mm_extract_epi32(index, 0)],
+            base[_mm_extract_epi32(index, 1)],
+            base[_mm_extract_epi32(index, 2)],
+            base[_mm_extract_epi32(index, 3)]
+        );
+    }
+
+    // Coefficients of the segment of every lane, coefficients[k] holds component k of all lanes. A segment is a
+    // cache line, loaded as three rows of 4 floats and transposed.
+    SIMD_TARGET("sse4.1") inline void loadSegmentsSse4(const float *segments, const __m128i index, __m128 *coefficients)
+    {
+        const float *lanes[4] = {
+            segments + _mm_extract_epi32(index, 0) * SEGMENT_STRIDE,
+            segments + _mm_extract_epi32(index, 1) * SEGMENT_STRIDE,
+            segments + _mm_extract_epi32(index, 2) * SEGMENT_STRIDE,
+            segments + _mm_extract_epi32(index, 3) * SEGMENT_STRIDE,
+        };
+        for (int row = 0; row < 3; ++row)
+        {
+            __m128 r0 = _mm_load_ps(lanes[0] + row * 4);
+            __m128 r1 = _mm_load_ps(lanes[1] + row * 4);
+            __m128 r2 = _mm_load_ps(lanes[2] + row * 4);
+            __m128 r3 = _mm_load_ps(lanes[3] + row * 4);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            coefficients[row * 4] = r0;
+            coefficients[row * 4 + 1] = r1;
+            coefficients[row * 4 + 2] = r2;
+            coefficients[row * 4 + 3] = r3;
+        }
+    }
+
+    SIMD_TARGET("sse4.1")
+    void evaluateSse4(const BatchView &batch, const float time, const size_t begin, const size_t end)
+    {
+        const __m128 time_vector = _mm_set1_ps(time);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi32(1);
+
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 path_time = _mm_div_ps(time_vector, _mm_loadu_ps(batch.periods + i));
+            const __m128i entries = _mm_loadu_si128(reinterpret_cast<const __m128i *>(batch.table_entries + i));
+            const __m128 loop_time =
+                _mm_mul_ps(_mm_sub_ps(path_time, _mm_floor_ps(path_time)), _mm_cvtepi32_ps(entries));
+            const __m128i entry =
+                _mm_max_epi32(_mm_min_epi32(_mm_cvttps_epi32(loop_time), _mm_sub_epi32(entries, one)), zero);
+            const __m128 entry_time = _mm_sub_ps(loop_time, _mm_cvtepi32_ps(entry));
+
+            const __m128i table_index = _mm_add_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(batch.table_offsets + i)), entry
+            );
+            const __m128 start = gatherSse4(batch.tables, table_index);
+            const __m128 next = gatherSse4(batch.tables + 1, table_index);
+            const __m128 parameter = _mm_add_ps(start, _mm_mul_ps(_mm_sub_ps(next, start), entry_time));
+
+            const __m128i counts = _mm_loadu_si128(reinterpret_cast<const __m128i *>(batch.segment_counts + i));
+            const __m128i segment =
+                _mm_max_epi32(_mm_min_epi32(_mm_cvttps_epi32(parameter), _mm_sub_epi32(counts, one)), zero);
+            const __m128 t = _mm_sub_ps(parameter, _mm_cvtepi32_ps(segment));
+            const __m128 three_t = _mm_mul_ps(_mm_set1_ps(3), t);
+
+            __m128 coefficients[12];
+            loadSegmentsSse4(
+                batch.segments,
+                _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(batch.segment_offsets + i)), segment),
+                coefficients
+            );
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const __m128 a = coefficients[axis];
+                const __m128 b = coefficients[3 + axis];
+                const __m128 c = coefficients[6 + axis];
+                const __m128 d = coefficients[9 + axis];
+
+                __m128 position = _mm_add_ps(_mm_mul_ps(a, t), b);
+                position = _mm_add_ps(_mm_mul_ps(position, t), c);
+                position = _mm_add_ps(_mm_mul_ps(position, t), d);
+                const __m128 derivative = _mm_add_ps(
+                    _mm_mul_ps(_mm_add_ps(_mm_mul_ps(a, three_t), _mm_mul_ps(b, _mm_set1_ps(2))), t), c
+                );
+
+                _mm_storeu_ps(batch.results[axis] + i, position);
+                _mm_storeu_ps(batch.results[3 + axis] + i, derivative);
+            }
+        }
+
+        evaluateScalar(batch, time, i, end);
+    }
+
+    // Same as loadSegmentsSse4 with lanes 4 to 7 in the upper half of every row
+    SIMD_TARGET("avx2") inline void loadSegmentsAvx2(const float *segments, const __m256i index, __m256 *coefficients)
+    {
+        alignas(32) int32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), index);
+        for (int row = 0; row < 3; ++row)
+        {
+            __m256 r[4];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                const float *low = segments + lanes[lane] * SEGMENT_STRIDE + row * 4;
+                const float *high = segments + lanes[lane + 4] * SEGMENT_STRIDE + row * 4;
+                r[lane] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(low)), _mm_load_ps(high), 1);
+            }
+
+            const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+            const __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+            const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+            const __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+            coefficients[row * 4] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            coefficients[row * 4 + 1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            coefficients[row * 4 + 2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            coefficients[row * 4 + 3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+    }
+
+    // Same as the SSE4 kernel with 8 lanes and FMA, the arc length tables are read with hardware gathers
+    SIMD_TARGET("avx2,fma")
+    void evaluateAvx2(const BatchView &batch, const float time, const size_t begin, const size_t end)
+    {
+        const __m256 time_vector = _mm256_set1_ps(time);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i one = _mm256_set1_epi32(1);
+
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            const __m256 path_time = _mm256_div_ps(time_vector, _mm256_loadu_ps(batch.periods + i));
+            const __m256i entries = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(batch.table_entries + i));
+            const __m256 loop_time =
+                _mm256_mul_ps(_mm256_sub_ps(path_time, _mm256_floor_ps(path_time)), _mm256_cvtepi32_ps(entries));
+            const __m256i entry = _mm256_max_epi32(
+                _mm256_min_epi32(_mm256_cvttps_epi32(loop_time), _mm256_sub_epi32(entries, one)), zero
+            );
+            const __m256 entry_time = _mm256_sub_ps(loop_time, _mm256_cvtepi32_ps(entry));
+
+            const __m256i table_index = _mm256_add_epi32(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(batch.table_offsets + i)), entry
+            );
+            const __m256 start = _mm256_i32gather_ps(batch.tables, table_index, 4);
+            const __m256 next = _mm256_i32gather_ps(batch.tables + 1, table_index, 4);
+            const __m256 parameter = _mm256_fmadd_ps(_mm256_sub_ps(next, start), entry_time, start);
+
+            const __m256i counts = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(batch.segment_counts + i));
+            const __m256i segment = _mm256_max_epi32(
+                _mm256_min_epi32(_mm256_cvttps_epi32(parameter), _mm256_sub_epi32(counts, one)), zero
+            );
+            const __m256 t = _mm256_sub_ps(parameter, _mm256_cvtepi32_ps(segment));
+            const __m256 three_t = _mm256_mul_ps(_mm256_set1_ps(3), t);
+
+            __m256 coefficients[12];
+            loadSegmentsAvx2(
+                batch.segments,
+                _mm256_add_epi32(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(batch.segment_offsets + i)), segment
+                ),
+                coefficients
+            );
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const __m256 a = coefficients[axis];
+                const __m256 b = coefficients[3 + axis];
+                const __m256 c = coefficients[6 + axis];
+                const __m256 d = coefficients[9 + axis];
+
+                __m256 position = _mm256_fmadd_ps(a, t, b);
+                position = _mm256_fmadd_ps(position, t, c);
+                position = _mm256_fmadd_ps(position, t, d);
+                const __m256 derivative =
+                    _mm256_fmadd_ps(_mm256_fmadd_ps(a, three_t, _mm256_add_ps(b, b)), t, c);
+
+                _mm256_storeu_ps(batch.results[axis] + i, position);
+                _mm256_storeu_ps(batch.results[3 + axis] + i, derivative);
+            }
+        }
+
+        evaluateSse4(batch, time, i, end);
+    }
+#endif
+
+#ifdef SIMD_NEON
+    inline float32x4_t gatherNeon(const float *base, const int32x4_t index)
+    {
+        float32x4_t result = vdupq_n_f32(base[vgetq_lane_s32(index, 0)]);
+        result = vsetq_lane_f32(base[vgetq_lane_s32(index, 1)], result, 1);
+        result = vsetq_lane_f32(base[vgetq_lane_s32(index, 2)], result, 2);
+        return vsetq_lane_f32(base[vgetq_lane_s32(index, 3)], result, 3);
+    }
+
+    // Same as loadSegmentsSse4
+    inline void loadSegmentsNeon(const float *segments, const int32x4_t index, float32x4_t *coefficients)
+    {
+        const float *lanes[4] = {
+            segments + vgetq_lane_s32(index, 0) * SEGMENT_STRIDE,
+            segments + vgetq_lane_s32(index, 1) * SEGMENT_STRIDE,
+            segments + vgetq_lane_s32(index, 2) * SEGMENT_STRIDE,
+            segments + vgetq_lane_s32(index, 3) * SEGMENT_STRIDE,
+        };
+        for (int row = 0; row < 3; ++row)
+        {
+            const float32x4x2_t t01 = vtrnq_f32(vld1q_f32(lanes[0] + row * 4), vld1q_f32(lanes[1] + row * 4));
+            const float32x4x2_t t23 = vtrnq_f32(vld1q_f32(lanes[2] + row * 4), vld1q_f32(lanes[3] + row * 4));
+            coefficients[row * 4] = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+            coefficients[row * 4 + 1] = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+            coefficients[row * 4 + 2] = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+            coefficients[row * 4 + 3] = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+        }
+    }
+
+    void evaluateNeon(const BatchView &batch, const float time, const size_t begin, const size_t end)
+    {
+        const float32x4_t time_vector = vdupq_n_f32(time);
+        const int32x4_t zero = vdupq_n_s32(0);
+        const int32x4_t one = vdupq_n_s32(1);
+
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            const float32x4_t path_time = vdivq_f32(time_vector, vld1q_f32(batch.periods + i));
+            const int32x4_t entries = vld1q_s32(batch.table_entries + i);
+            const float32x4_t loop_time =
+                vmulq_f32(vsubq_f32(path_time, vrndmq_f32(path_time)), vcvtq_f32_s32(entries));
+            const int32x4_t entry = vmaxq_s32(vminq_s32(vcvtq_s32_f32(loop_time), vsubq_s32(entries, one)), zero);
+            const float32x4_t entry_time = vsubq_f32(loop_time, vcvtq_f32_s32(entry));
+
+            const int32x4_t table_index = vaddq_s32(vld1q_s32(batch.table_offsets + i), entry);
+            const float32x4_t start = gatherNeon(batch.tables, table_index);
+            const float32x4_t next = gatherNeon(batch.tables + 1, table_index);
+            const float32x4_t parameter = vaddq_f32(start, vmulq_f32(vsubq_f32(next, start), entry_time));
+
+            const int32x4_t counts = vld1q_s32(batch.segment_counts + i);
+            const int32x4_t segment = vmaxq_s32(vminq_s32(vcvtq_s32_f32(parameter), vsubq_s32(counts, one)), zero);
+            const float32x4_t t = vsubq_f32(parameter, vcvtq_f32_s32(segment));
+            const float32x4_t three_t = vmulq_n_f32(t, 3);
+
+            float32x4_t coefficients[12];
+            loadSegmentsNeon(batch.segments, vaddq_s32(vld1q_s32(batch.segment_offsets + i), segment), coefficients);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float32x4_t a = coefficients[axis];
+                const float32x4_t b = coefficients[3 + axis];
+                const float32x4_t c = coefficients[6 + axis];
+                const float32x4_t d = coefficients[9 + axis];
+
+                float32x4_t position = vaddq_f32(vmulq_f32(a, t), b);
+                position = vaddq_f32(vmulq_f32(position, t), c);
+                position = vaddq_f32(vmulq_f32(position, t), d);
+                const float32x4_t derivative =
+                    vaddq_f32(vmulq_f32(vaddq_f32(vmulq_f32(a, three_t), vmulq_n_f32(b, 2)), t), c);
+
+                vst1q_f32(batch.results[axis] + i, position);
+                vst1q_f32(batch.results[3 + axis] + i, derivative);
+            }
+        }
+
+        evaluateScalar(batch, time, i, end);
+    }
+#endif
+
+    using EvaluateKernel = void (*)(const BatchView &, float, size_t, size_t);
+
+    // Indexed by simd::InstructionSet, instruction sets not available in this architecture fall back to scalar
+    constexpr EvaluateKernel EVALUATE_KERNELS[static_cast<int>(simd::InstructionSet::COUNT)] = {
+        evaluateScalar,
+#ifdef SIMD_X86
+        evaluateSse4,
+        evaluateAvx2,
+#else
+        evaluateScalar,
+        evaluateScalar,
+#endif
+#ifdef SIMD_NEON
+        evaluateNeon,
+#else
+        evaluateScalar,
+#endif
+    };
+} // namespace
+
+void SplineBatch::Clear()
+{
+    m_segments.clear();
+    m_arc_length_tables.clear();
+    m_segment_offsets.clear();
+    m_segment_counts.clear();
+    m_table_offsets.clear();
+    m_table_entries.clear();
+    m_periods.clear();
+    for (auto &component : m_results)
+        component.clear();
+}
+
+size_t SplineBatch::Add(const CatmullRomSpline &spline, const float period)
+{
+    const auto &segments = spline.GetSegments();
+    m_segment_offsets.push_back(static_cast<int32_t>(m_segments.size()));
+    m_segment_counts.push_back(static_cast<int32_t>(segments.size()));
+    for (const auto &segment : segments)
+    {
+        m_segments.push_back({{
+            segment.a.x, segment.a.y, segment.a.z,
+            segment.b.x, segment.b.y, segment.b.z,
+            segment.c.x, segment.c.y, segment.c.z,
+            segment.d.x, segment.d.y, segment.d.z,
+        }});
+    }
+
+    m_table_offsets.push_back(static_cast<int32_t>(m_arc_length_tables.size()));
+    if (spline.IsConstantSpeed())
+    {
+        const auto &table = spline.GetArcLengthTable();
+        m_table_entries.push_back(static_cast<int32_t>(table.size() - 1));
+        m_arc_length_tables.insert(m_arc_length_tables.end(), table.begin(), table.end());
+    }
+    else
+    {
+        m_table_entries.push_back(1);
+        m_arc_length_tables.push_back(0);
+        m_arc_length_tables.push_back(static_cast<float>(segments.size()));
+    }
+
+    m_periods.push_back(period);
+    for (auto &component : m_results)
+        component.emplace_back();
+    return m_periods.size() - 1;
+}
+
+void SplineBatch::Evaluate(const float time)
+{
+    const BatchView batch = {
+        reinterpret_cast<const float *>(m_segments.data()),
+        m_arc_length_tables.data(),
+        m_segment_offsets.data(),
+        m_segment_counts.data(),
+        m_table_offsets.data(),
+        m_table_entries.data(),
+        m_periods.data(),
+        {m_results[0].data(),
+         m_results[1].data(),
+         m_results[2].data(),
+         m_results[3].data(),
+         m_results[4].data(),
+         m_results[5].data()},
+    };
+    EVALUATE_KERNELS[static_cast<int>(simd::GetActive())](batch, time, 0, Size());
+}
@@ -0,0 +1,55 @@
+#ifndef CG_SOLAR_SYSTEM_SPLINE_BATCH_H
+#define CG_SOLAR_SYSTEM_SPLINE_BATCH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Spline.h"
+#include "Vec.h"
+
+// Every spline of a scene in structure of arrays, so all of them are evaluated at the same time in one pass through
+// the SIMD kernels of simd::GetActive(), 4 (SSE4, NEON) or 8 (AVX2) splines per iteration. The segment each lane needs
+// is one cache line, loaded in rows and transposed instead of gathered a float at a time.
+// Gives the same results as CatmullRomSpline::Evaluate(time / period) except with AVX2, which uses FMA.
+class SplineBatch
+{
+    // Coefficients of one segment, a.x a.y a.z b.x ... d.z, padded to a cache line
+    struct alignas(64) SegmentCoefficients
+    {
+        float values[16];
+    };
+
+    std::vector<SegmentCoefficients> m_segments; // of every spline, one after the other
+    // Arc length tables of every spline. Splines without one get {0, segment count}, which maps time the same way.
+    std::vector<float> m_arc_length_tables;
+
+    std::vector<int32_t> m_segment_offsets;
+    std::vector<int32_t> m_segment_counts;
+    std::vector<int32_t> m_table_offsets;
+    std::vector<int32_t> m_table_entries;
+    std::vector<float> m_periods; // time to go through the whole spline
+
+    // Results of the last Evaluate: position x y z and derivative x y z
+    std::array<std::vector<float>, 6> m_results;
+
+public:
+    void Clear();
+
+    // Adds a spline that is not empty and returns its index
+    size_t Add(const CatmullRomSpline &spline, float period);
+    size_t Size() const { return m_periods.size(); }
+
+    void Evaluate(float time);
+    Vec3f GetPosition(const size_t index) const
+    {
+        return {m_results[0][index], m_results[1][index], m_results[2][index]};
+    }
+    Vec3f GetDerivative(const size_t index) const
+    {
+        return {m_results[3][index], m_results[4][index], m_results[5][index]};
+    }
+};
+
+#endif // CG_SOLAR_SYSTEM_SPLINE_BATCH_H
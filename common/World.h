@@ -2,7 +2,9 @@
 #define WORLD_H
 
 #include <algorithm>
+#include <bit>
 #include <cstdint>
+#include <initializer_list>
 #include <iostream>
 #include <optional>
 #include <string>
@@ -12,8 +14,12 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 
+#include "BakedAnimation.h"
 #include "Color.h"
+#include "Kepler.h"
 #include "Mat.h"
+#include "Quat.h"
+#include "Spline.h"
 #include "Vec.h"
 
 namespace world
@@ -57,7 +63,7 @@ namespace world
             float angle_rads{0};
             Vec3f axis{0, 0, 0};
 
-            Mat4f GetTransform(float) const { return Mat4fRotate(angle_rads, axis.x, axis.y, axis.z); }
+            Mat3x4f GetTransform(float) const { return QuatfFromAxisAngle(angle_rads, axis).ToMat3x4f(); }
 
             Rotation() = default;
             explicit Rotation(const float angle_rads, Vec3f axis) : angle_rads(angle_rads), axis(std::move(axis)) {}
@@ -68,11 +74,47 @@ namespace world
             float time_to_complete = {1};
             Vec3f axis{0, 1, 0};
 
-            Mat4f GetTransform(float time) const
+            // The rotation is advanced from the one of the previous frame with a small angle step instead of being
+            // rebuilt with sin/cos every frame. It's rebuilt exactly when time goes back or jumps, when the
+            // parameters change, and every ROTATION_RESYNC_STEPS frames so float error can't accumulate.
+            static constexpr int ROTATION_RESYNC_STEPS = 256;
+            Quatf cached_rotation = {};
+            Vec3f cached_unit_axis = {0, 1, 0};
+            float cached_time = 0;
+            int steps_since_resync = 0;
+            bool rotation_dirty = true; // true if the axis or time_to_complete changed
+
+            Mat3x4f GetTransform(float time) { return getRotation(time).ToMat3x4f(); }
+
+            Quatf getRotation(float time)
             {
-                return Mat4fRotate(time * M_PI * 2 / time_to_complete, axis.x, axis.y, axis.z);
+                const float delta_time = time - cached_time;
+                const float delta_angle = delta_time * M_PI * 2 / time_to_complete;
+
+                if (rotation_dirty || delta_time < 0 || fabsf(delta_angle) > QUATF_SMALL_ANGLE ||
+                    steps_since_resync >= ROTATION_RESYNC_STEPS)
+                {
+                    cached_unit_axis = axis.Normalize();
+                    // Only the fraction of the current turn matters, dropping the full turns in double keeps the
+                    // float angle precise after a long time
+                    const double turns = static_cast<double>(time) / time_to_complete;
+                    cached_rotation = QuatfFromAxisAngle((turns - floor(turns)) * M_PI * 2, cached_unit_axis);
+                    steps_since_resync = 0;
+                    rotation_dirty = false;
+                }
+                else if (delta_time > 0)
+                {
+                    // Both rotate around the same axis, so the order doesn't matter
+                    cached_rotation = QuatfFromSmallAngle(delta_angle, cached_unit_axis) * cached_rotation;
+                    steps_since_resync++;
+                }
+
+                cached_time = time;
+                return cached_rotation;
             }
 
+            void updateRotation() { rotation_dirty = true; }
+
             RotationWithTime() = default;
             explicit RotationWithTime(const float time_to_complete, Vec3f axis) :
                 time_to_complete(time_to_complete), axis(std::move(axis))
@@ -84,7 +126,7 @@ namespace world
         {
             Vec3f translation{0, 0, 0};
 
-            Mat4f GetTransform(float) const { return Mat4fTranslate(translation.x, translation.y, translation.z); }
+            Mat3x4f GetTransform(float) const { return Mat3x4fTranslate(translation.x, translation.y, translation.z); }
 
             Translation() = default;
             explicit Translation(Vec3f translation) : translation(std::move(translation)) {}
@@ -94,48 +136,94 @@ namespace world
         {
             float time_to_complete = {1};
             bool align_to_path;
+            bool constant_speed = false; // moves the same distance every second, whatever the spacing of the points
             std::vector<Vec3f> points_to_follow;
 
-            uint32_t render_path_gpu_buffer = 0; // the buffer associated with the data uploaded to the GPU
-            bool render_path_dirty = true; // true if new data needs to be uploaded to the GPU (points change)
+            std::vector<Vec3f> render_path_vertexes; // of the drawn path, streamed to the GPU every frame
+            bool render_path_dirty = true; // true if the path vertexes need to be evaluated again (points change)
             bool render_path = true;
-            Vec3f last_y_vector = {0, 1, 0};
 
-            Mat4f GetTransform(float time)
+            CatmullRomSpline spline; // segment coefficients of points_to_follow
+            bool spline_dirty = true; // true if the spline needs to be rebuilt (points change)
+            RotationMinimizingFrames frames; // up vectors of the spline when aligned to it
+            bool frames_dirty = true; // true if the frames need to be rebuilt (points change)
+
+            size_t batch_index = 0; // index of the spline in the engine's scene SplineBatch
+            bool batch_dirty = true; // true if the SplineBatch has old data of this spline (points or time change)
+
+            const CatmullRomSpline &getSpline()
+            {
+                if (spline_dirty)
+                {
+                    spline.Build(points_to_follow, constant_speed);
+                    spline_dirty = false;
+                }
+                return spline;
+            }
+
+            const RotationMinimizingFrames &getFrames()
+            {
+                if (frames_dirty)
+                {
+                    frames.Build(getSpline());
+                    frames_dirty = false;
+                }
+                return frames;
+            }
+
+            // Builds what evaluating the path needs ahead, after which GetTransform only reads the transform and can
+            // be called for any time in any order, from any thread
+            void prepare()
+            {
+                if (points_to_follow.size() < 4)
+                    return;
+                getSpline();
+                if (align_to_path)
+                    getFrames();
+            }
+
+            Mat3x4f GetTransform(float time)
             {
                 if (points_to_follow.size() < 4)
-                    return Mat4fIdentity;
+                    return Mat3x4fIdentity;
 
                 Vec3f position;
                 Vec3f derivative;
-                getCatmullRomPoint(time / time_to_complete, points_to_follow, position, derivative);
-
-                Mat4f result = Mat4fTranslate(position.x, position.y, position.z);
-
-                if (align_to_path)
-                {
-                    Vec3f x_vector = derivative.Normalize();
-                    Vec3f z_vector = x_vector.Cross(last_y_vector).Normalize();
-                    Vec3f y_vector = z_vector.Cross(x_vector).Normalize();
+                getSpline().Evaluate(time / time_to_complete, position, derivative);
+                return GetTransform(time, position, derivative);
+            }
 
-                    last_y_vector = y_vector;
+            // Transform at time with the point of the path there already evaluated, by the SplineBatch
+            Mat3x4f GetTransform(float time, const Vec3f &position, const Vec3f &derivative)
+            {
+                if (!align_to_path)
+                    return Mat3x4fTranslate(position.x, position.y, position.z);
 
-                    result *=
-                        {{{x_vector.x, y_vector.x, z_vector.x, 0},
-                          {x_vector.y, y_vector.y, z_vector.y, 0},
-                          {x_vector.z, y_vector.z, z_vector.z, 0},
-                          {0, 0, 0, 1}}};
-                }
+                Vec3f x_vector = derivative.Normalize();
+                Vec3f z_vector = x_vector.Cross(getFrames().GetUp(time / time_to_complete)).Normalize();
+                Vec3f y_vector = z_vector.Cross(x_vector).Normalize();
 
-                return result;
+                return Mat3x4fFromBasis(x_vector, y_vector, z_vector, position);
             }
 
-            void updatePoints() { render_path_dirty = true; }
+            void updatePoints()
+            {
+                render_path_dirty = true;
+                spline_dirty = true;
+                frames_dirty = true;
+                batch_dirty = true;
+            }
 
             TranslationThroughPoints() = default;
 
-            explicit TranslationThroughPoints(const float time, bool align, std::vector<Vec3f> points) :
-                time_to_complete(time), align_to_path(align), points_to_follow(std::move(points))
+            explicit TranslationThroughPoints(
+                const float time,
+                bool align,
+                std::vector<Vec3f> points,
+                bool constant_speed = false
+            ) :
+                time_to_complete(time), align_to_path(align), constant_speed(constant_speed),
+                points_to_follow(std::move(points))
             {
             }
         };
@@ -144,23 +232,391 @@ namespace world
         {
             Vec3f scale{1, 1, 1};
 
-            Mat4f GetTransform(float) const { return Mat4fScale(scale.x, scale.y, scale.z); }
+            Mat3x4f GetTransform(float) const { return Mat3x4fScale(scale.x, scale.y, scale.z); }
 
             Scale() = default;
             explicit Scale(Vec3f scale) : scale(std::move(scale)) {}
         };
 
-        using Transform = std::variant<Rotation, RotationWithTime, Translation, TranslationThroughPoints, Scale>;
+        // Elliptic orbit around the origin, evaluated in closed form from its Keplerian elements instead of a spline
+        // through points of it
+        struct KeplerOrbit
+        {
+            float semi_major_axis = {1};
+            float eccentricity = {0}; // clamped to [0, KEPLER_MAX_ECCENTRICITY]
+            float inclination_rads = {0};
+            float ascending_node_rads = {0};
+            float periapsis_argument_rads = {0};
+            float mean_anomaly_at_epoch_rads = {0}; // where the orbit starts, at time 0
+            float time_to_complete = {1}; // orbital period
+
+            std::vector<Vec3f> render_path_vertexes; // of the drawn path, streamed to the GPU every frame
+            bool render_path_dirty = true; // true if the path vertexes need to be evaluated again (elements change)
+            bool render_path = true;
+
+            KeplerEllipse ellipse; // of the elements above
+            bool ellipse_dirty = true; // true if the ellipse needs to be rebuilt (elements change)
+
+            const KeplerEllipse &getEllipse()
+            {
+                if (ellipse_dirty)
+                {
+                    ellipse = KeplerEllipse(
+                        semi_major_axis, std::clamp(eccentricity, 0.0f, KEPLER_MAX_ECCENTRICITY), inclination_rads,
+                        ascending_node_rads, periapsis_argument_rads
+                    );
+                    ellipse_dirty = false;
+                }
+                return ellipse;
+            }
+
+            Vec3f GetPosition(float time)
+            {
+                // Like RotationWithTime, only the fraction of the current orbit is kept, in double
+                const double turns =
+                    static_cast<double>(time) / time_to_complete + mean_anomaly_at_epoch_rads * (M_1_PI / 2) + 0.5;
+                const float mean_anomaly = static_cast<float>((turns - floor(turns) - 0.5) * M_PI * 2);
+                return getEllipse().PositionAtMeanAnomaly(mean_anomaly);
+            }
+
+            Mat3x4f GetTransform(float time)
+            {
+                const Vec3f position = GetPosition(time);
+                return Mat3x4fTranslate(position.x, position.y, position.z);
+            }
+
+            void updateOrbit()
+            {
+                render_path_dirty = true;
+                ellipse_dirty = true;
+            }
+
+            KeplerOrbit() = default;
+
+            explicit KeplerOrbit(
+                const float time,
+                const float semi_major_axis,
+                const float eccentricity = 0,
+                const float inclination_rads = 0,
+                const float ascending_node_rads = 0,
+                const float periapsis_argument_rads = 0,
+                const float mean_anomaly_at_epoch_rads = 0
+            ) :
+                semi_major_axis(semi_major_axis), eccentricity(eccentricity), inclination_rads(inclination_rads),
+                ascending_node_rads(ascending_node_rads), periapsis_argument_rads(periapsis_argument_rads),
+                mean_anomaly_at_epoch_rads(mean_anomaly_at_epoch_rads), time_to_complete(time)
+            {
+            }
+        };
+
+        using Transform =
+            std::variant<Rotation, RotationWithTime, Translation, TranslationThroughPoints, Scale, KeplerOrbit>;
     } // namespace transform
 
+    // Instructions of a compiled GroupTransform, every opcode is followed by its parameters in the program
+    enum class TransformOpcode : uint32_t
+    {
+        TRANSLATE, // x y z
+        SCALE, // x y z
+        MATRIX, // the 3 rows of the 4 columns of a Mat3x4f, the product of time independent transforms
+        ROTATE_WITH_TIME, // index of the transform, which keeps state between frames
+        TRANSLATE_THROUGH_POINTS, // index of the transform
+        KEPLER_ORBIT, // index of the transform
+    };
+
+    // Longest period of a baked group, as a multiple of the longest period of its transforms
+    constexpr int BAKE_MAX_PERIOD_MULTIPLE = 8;
+
+    enum class BakeResult
+    {
+        STATIC, // nothing depends on time, the compiled program is already a single matrix at most
+        BAKED,
+        NOT_PERIODIC, // the periods of the transforms don't line up within BAKE_MAX_PERIOD_MULTIPLE
+        OVER_TOLERANCE, // not even BAKE_MAX_KEYS keys are within the tolerance, or the transform has shear
+    };
+
     class GroupTransform
     {
         std::vector<transform::Transform> m_transformations = {};
+        // m_transformations compiled to 32-bit words, so evaluating them is a switch over tightly packed opcodes
+        // and parameters instead of a std::visit of every variant. Consecutive time independent transforms are
+        // folded into one matrix, and a translation or scale on its own is applied in place.
+        std::vector<uint32_t> m_program = {};
+        // Matrix products per evaluation saved against multiplying every transform: folded, applied in place, or the
+        // first one, which replaces the identity
+        size_t m_removed_products = 0;
+        bool m_program_dirty = true;
+        bool m_time_dependent = false; // if any transform of the program changes with time
+        size_t m_version = 0; // bumped by every edit, so caches of the product can tell they are stale
+        // The whole product sampled over its period, evaluated instead of the program in scenes that bake animations
+        std::optional<BakedAnimation> m_baked = {};
+
+        void pushFloats(std::initializer_list<float> values)
+        {
+            for (const float value : values)
+                m_program.push_back(std::bit_cast<uint32_t>(value));
+        }
+
+        // Opcodes that multiply the result by a matrix, except the first one which only assigns it
+        void pushProductOpcode(const TransformOpcode opcode)
+        {
+            if (!m_program.empty())
+                m_removed_products--;
+            m_program.push_back(static_cast<uint32_t>(opcode));
+        }
+
+        static bool isTimeIndependent(const transform::Transform &transform)
+        {
+            return std::holds_alternative<transform::Translation>(transform) ||
+                std::holds_alternative<transform::Scale>(transform) ||
+                std::holds_alternative<transform::Rotation>(transform);
+        }
+
+        // Emits the time independent transforms [begin, end[
+        void compileStaticRun(const size_t begin, const size_t end)
+        {
+            if (end - begin == 1)
+            {
+                const auto &transform = m_transformations[begin];
+                if (const auto *translation = std::get_if<transform::Translation>(&transform))
+                {
+                    m_program.push_back(static_cast<uint32_t>(TransformOpcode::TRANSLATE));
+                    pushFloats({translation->translation.x, translation->translation.y, translation->translation.z});
+                    return;
+                }
+                if (const auto *scale = std::get_if<transform::Scale>(&transform))
+                {
+                    m_program.push_back(static_cast<uint32_t>(TransformOpcode::SCALE));
+                    pushFloats({scale->scale.x, scale->scale.y, scale->scale.z});
+                    return;
+                }
+            }
+
+            Mat3x4f folded = Mat3x4fIdentity;
+            for (size_t i = begin; i < end; ++i)
+            {
+                folded *= std::visit([](auto &&arg) { return arg.GetTransform(0); }, m_transformations[i]);
+            }
+
+            pushProductOpcode(TransformOpcode::MATRIX);
+            for (const auto &column : folded.cols)
+                pushFloats({column[0], column[1], column[2]});
+        }
+
+        static std::optional<float> transformPeriod(const transform::Transform &transform)
+        {
+            if (const auto *rotation = std::get_if<transform::RotationWithTime>(&transform))
+                return fabsf(rotation->time_to_complete);
+            if (const auto *translation = std::get_if<transform::TranslationThroughPoints>(&transform))
+                return fabsf(translation->time_to_complete);
+            if (const auto *orbit = std::get_if<transform::KeplerOrbit>(&transform))
+                return fabsf(orbit->time_to_complete);
+            return std::nullopt;
+        }
+
+        // Shortest time after which every transform is back where it started, 0 if none depends on time
+        std::optional<float> period() const
+        {
+            std::vector<float> periods;
+            for (const auto &transform : m_transformations)
+            {
+                if (const auto transform_period = transformPeriod(transform))
+                    periods.push_back(*transform_period);
+            }
+            if (periods.empty())
+                return 0.0f;
+
+            const float longest = *std::ranges::max_element(periods);
+            if (*std::ranges::min_element(periods) <= 0)
+                return std::nullopt;
+
+            for (int multiple = 1; multiple <= BAKE_MAX_PERIOD_MULTIPLE; ++multiple)
+            {
+                const float candidate = longest * static_cast<float>(multiple);
+                const bool lines_up = std::ranges::all_of(
+                    periods,
+                    [candidate](const float transform_period)
+                    {
+                        const float turns = candidate / transform_period;
+                        return fabsf(turns - roundf(turns)) < 1e-4f * turns;
+                    }
+                );
+                if (lines_up)
+                    return candidate;
+            }
+            return std::nullopt;
+        }
+
+        void compile()
+        {
+            m_program.clear();
+            m_removed_products = m_transformations.size();
+            m_time_dependent = !std::ranges::all_of(m_transformations, isTimeIndependent);
+            for (size_t i = 0; i < m_transformations.size();)
+            {
+                if (isTimeIndependent(m_transformations[i]))
+                {
+                    size_t end = i + 1;
+                    while (end < m_transformations.size() && isTimeIndependent(m_transformations[end]))
+                        ++end;
+                    compileStaticRun(i, end);
+                    i = end;
+                    continue;
+                }
+
+                if (std::holds_alternative<transform::RotationWithTime>(m_transformations[i]))
+                {
+                    pushProductOpcode(TransformOpcode::ROTATE_WITH_TIME);
+                }
+                else if (auto *translation = std::get_if<transform::TranslationThroughPoints>(&m_transformations[i]))
+                {
+                    translation->prepare();
+                    pushProductOpcode(TransformOpcode::TRANSLATE_THROUGH_POINTS);
+                }
+                else
+                {
+                    // Only a translation, applied in place
+                    m_program.push_back(static_cast<uint32_t>(TransformOpcode::KEPLER_ORBIT));
+                }
+                m_program.push_back(static_cast<uint32_t>(i));
+                ++i;
+            }
+            m_program_dirty = false;
+        }
 
     public:
-        void AddTransform(const transform::Transform &transform) { m_transformations.push_back(transform); }
+        void AddTransform(const transform::Transform &transform)
+        {
+            m_transformations.push_back(transform);
+            MarkDirty();
+        }
+        // MarkDirty has to be called after changing the list or the parameters of a transform through it
         std::vector<transform::Transform> &GetTransformations() { return m_transformations; }
-        void RemoveTransform(const size_t index) { m_transformations.erase(m_transformations.begin() + index); }
+        void RemoveTransform(const size_t index)
+        {
+            m_transformations.erase(m_transformations.begin() + index);
+            MarkDirty();
+        }
+        void MarkDirty()
+        {
+            m_program_dirty = true;
+            m_version++;
+            m_baked.reset();
+        }
+        size_t GetVersion() const { return m_version; }
+
+        // If the product changes with time, otherwise it only changes when the transforms are edited
+        bool IsTimeDependent()
+        {
+            if (m_program_dirty)
+                compile();
+            return m_time_dependent;
+        }
+
+        const std::vector<uint32_t> &GetProgram()
+        {
+            if (m_program_dirty)
+                compile();
+            return m_program;
+        }
+
+        size_t GetRemovedProducts()
+        {
+            if (m_program_dirty)
+                compile();
+            return m_removed_products;
+        }
+
+        // Samples the product of the transforms over its period into a BakedAnimation, see BakeResult.
+        // Editing the transforms drops it.
+        BakeResult Bake(const float tolerance)
+        {
+            m_baked.reset();
+            const auto baked_period = period();
+            if (!baked_period)
+                return BakeResult::NOT_PERIODIC;
+            if (*baked_period == 0)
+                return BakeResult::STATIC;
+
+            m_baked =
+                BakedAnimation::Bake(*baked_period, tolerance, [this](const float time) { return Evaluate(time); });
+            return m_baked ? BakeResult::BAKED : BakeResult::OVER_TOLERANCE;
+        }
+        const std::optional<BakedAnimation> &GetBaked() const { return m_baked; }
+        void ClearBaked() { m_baked.reset(); }
+
+        // Product of all the transforms at time. path_transform(translation, previous) returns the transform of a
+        // TranslationThroughPoints and orbit_position(orbit, previous) the position on a KeplerOrbit, previous is the
+        // product of the transforms before it.
+        template <typename PathTransform, typename OrbitPosition>
+        Mat3x4f Evaluate(const float time, PathTransform &&path_transform, OrbitPosition &&orbit_position)
+        {
+            const auto &program = GetProgram();
+            const auto parameter = [&](const size_t index) { return std::bit_cast<float>(program[index]); };
+
+            Mat3x4f result = Mat3x4fIdentity;
+            for (size_t i = 0; i < program.size();)
+            {
+                switch (static_cast<TransformOpcode>(program[i]))
+                {
+                    case TransformOpcode::TRANSLATE:
+                        result.Translate(parameter(i + 1), parameter(i + 2), parameter(i + 3));
+                        i += 4;
+                        break;
+                    case TransformOpcode::SCALE:
+                        result.Scale(parameter(i + 1), parameter(i + 2), parameter(i + 3));
+                        i += 4;
+                        break;
+                    case TransformOpcode::MATRIX:
+                    {
+                        Mat3x4f matrix = Mat3x4fIdentity;
+                        for (int column = 0; column < 4; ++column)
+                        {
+                            for (int row = 0; row < 3; ++row)
+                                matrix.cols[column][row] = parameter(i + 1 + column * 3 + row);
+                        }
+                        result = i == 0 ? matrix : result * matrix;
+                        i += 13;
+                        break;
+                    }
+                    case TransformOpcode::ROTATE_WITH_TIME:
+                    {
+                        auto &rotation = std::get<transform::RotationWithTime>(m_transformations[program[i + 1]]);
+                        result = i == 0 ? rotation.GetTransform(time) : result * rotation.GetTransform(time);
+                        i += 2;
+                        break;
+                    }
+                    case TransformOpcode::TRANSLATE_THROUGH_POINTS:
+                    {
+                        auto &translation =
+                            std::get<transform::TranslationThroughPoints>(m_transformations[program[i + 1]]);
+                        const Mat3x4f matrix = path_transform(translation, result);
+                        result = i == 0 ? matrix : result * matrix;
+                        i += 2;
+                        break;
+                    }
+                    case TransformOpcode::KEPLER_ORBIT:
+                    {
+                        auto &orbit = std::get<transform::KeplerOrbit>(m_transformations[program[i + 1]]);
+                        const Vec3f position = orbit_position(orbit, result);
+                        result.Translate(position.x, position.y, position.z);
+                        i += 2;
+                        break;
+                    }
+                }
+            }
+            return result;
+        }
+
+        Mat3x4f Evaluate(const float time)
+        {
+            return Evaluate(
+                time,
+                [time](transform::TranslationThroughPoints &translation, const Mat3x4f &)
+                { return translation.GetTransform(time); },
+                [time](transform::KeplerOrbit &orbit, const Mat3x4f &) { return orbit.GetPosition(time); }
+            );
+        }
     };
 
     namespace lighting
@@ -216,6 +672,67 @@ namespace world
         explicit WorldGroup(std::string name) : name(std::make_optional(name)) {}
     };
 
+    // Compiles the transforms of group and its children ahead of the first frame, folding the time independent ones and
+    // building the splines and frames of the paths. Returns the matrix products per frame removed.
+    inline size_t CompileTransforms(WorldGroup &group)
+    {
+        size_t removed_products = group.transformations.GetRemovedProducts();
+        for (auto &child : group.children)
+        {
+            removed_products += CompileTransforms(child);
+        }
+        return removed_products;
+    }
+
+    struct BakeStats
+    {
+        size_t baked_groups = 0;
+        size_t not_periodic_groups = 0;
+        size_t over_tolerance_groups = 0;
+        size_t keys = 0;
+        size_t bytes = 0;
+        float max_error = 0; // world units at the corners of the unit cube, in the space of the parent group
+    };
+
+    // Bakes the transforms of group and its children, see GroupTransform::Bake
+    inline void BakeTransforms(WorldGroup &group, const float tolerance, BakeStats &stats)
+    {
+        switch (group.transformations.Bake(tolerance))
+        {
+            case BakeResult::STATIC:
+                break;
+            case BakeResult::BAKED:
+            {
+                const auto &baked = *group.transformations.GetBaked();
+                stats.baked_groups++;
+                stats.keys += baked.GetKeyCount();
+                stats.bytes += baked.GetBytes();
+                stats.max_error = std::max(stats.max_error, baked.GetMaxError());
+                break;
+            }
+            case BakeResult::NOT_PERIODIC:
+                stats.not_periodic_groups++;
+                break;
+            case BakeResult::OVER_TOLERANCE:
+                stats.over_tolerance_groups++;
+                break;
+        }
+
+        for (auto &child : group.children)
+        {
+            BakeTransforms(child, tolerance, stats);
+        }
+    }
+
+    inline void ClearBakedTransforms(WorldGroup &group)
+    {
+        group.transformations.ClearBaked();
+        for (auto &child : group.children)
+        {
+            ClearBakedTransforms(child);
+        }
+    }
+
     class World
     {
         std::string m_file_path;
@@ -225,6 +742,9 @@ namespace world
         WorldGroup m_parent_world_group;
         std::vector<lighting::Light> m_lights;
         bool m_default_lighting_mode = true; // true if the lighting is enabled by default in this world
+        // true if the periodic transforms are baked into tables when the world is loaded, see BakeTransforms
+        bool m_bake_animations = false;
+        float m_bake_tolerance = 0.01f;
 
         std::vector<std::string> m_model_names = {};
         std::vector<std::string> m_texture_names = {};
@@ -240,6 +760,9 @@ namespace world
         std::vector<lighting::Light> &getLights() { return m_lights; }
         bool GetDefaultLightingMode() const { return m_default_lighting_mode; }
         void SetDefaultLightingMode(bool default_lighting_mode) { m_default_lighting_mode = default_lighting_mode; }
+        bool GetBakeAnimations() const { return m_bake_animations; }
+        void SetBakeAnimations(bool bake_animations) { m_bake_animations = bake_animations; }
+        float &GetBakeTolerance() { return m_bake_tolerance; }
 
         size_t AddModelName(const std::string &model_name)
         {
@@ -100,6 +100,10 @@ namespace world::serde
 #endif
                         bool align = align_string != nullptr && strcasecmp(align_string, "true") == 0;
 
+                        const char *constant_speed_string = transform_element->Attribute("constant_speed");
+                        bool constant_speed =
+                            constant_speed_string != nullptr && strcasecmp(constant_speed_string, "true") == 0;
+
                         std::vector<Vec3f> points_to_follow;
                         for (auto point_element = transform_element->FirstChildElement("point"); point_element;
                              point_element = point_element->NextSiblingElement("point"))
@@ -109,9 +113,9 @@ namespace world::serde
                             points_to_follow.push_back(point);
                         }
 
-                        group.transformations.AddTransform(
-                            transform::TranslationThroughPoints(time_to_complete, align, points_to_follow)
-                        );
+                        group.transformations.AddTransform(transform::TranslationThroughPoints(
+                            time_to_complete, align, points_to_follow, constant_speed
+                        ));
                     }
                     else
                     {
@@ -126,6 +130,30 @@ namespace world::serde
                     LOAD_VEC3F(transform_element, scale, std::nullopt)
                     group.transformations.AddTransform(transform::Scale(scale));
                 }
+                else if (strcmp(transform_element->Name(), "orbit") == 0)
+                {
+                    transform::KeplerOrbit orbit;
+                    LOAD_ATTRIBUTE(transform_element, "time", orbit.time_to_complete, std::nullopt)
+                    LOAD_ATTRIBUTE(transform_element, "semi_major_axis", orbit.semi_major_axis, std::nullopt)
+                    transform_element->QueryFloatAttribute("eccentricity", &orbit.eccentricity);
+                    EARLY_RETURN_R(
+                        orbit.eccentricity < 0 || orbit.eccentricity > KEPLER_MAX_ECCENTRICITY,
+                        "Orbit eccentricity must be between 0 and " << KEPLER_MAX_ECCENTRICITY << ".",
+                        std::nullopt
+                    )
+
+                    // Angles in degrees, 0 if missing
+                    float inclination = 0, ascending_node = 0, periapsis_argument = 0, mean_anomaly = 0;
+                    transform_element->QueryFloatAttribute("inclination", &inclination);
+                    transform_element->QueryFloatAttribute("ascending_node", &ascending_node);
+                    transform_element->QueryFloatAttribute("periapsis_argument", &periapsis_argument);
+                    transform_element->QueryFloatAttribute("mean_anomaly", &mean_anomaly);
+                    orbit.inclination_rads = degrees_to_radians(inclination);
+                    orbit.ascending_node_rads = degrees_to_radians(ascending_node);
+                    orbit.periapsis_argument_rads = degrees_to_radians(periapsis_argument);
+                    orbit.mean_anomaly_at_epoch_rads = degrees_to_radians(mean_anomaly);
+                    group.transformations.AddTransform(orbit);
+                }
                 else if (strcmp(transform_element->Name(), "rotate") == 0)
                 {
                     Vec3f axis;
@@ -180,6 +208,11 @@ namespace world::serde
         const auto world_element = doc.FirstChildElement("world");
         EARLY_RETURN_FALSE(!world_element, "World XML file is missing the world element.")
 
+        bool bake_animations = false;
+        world_element->QueryBoolAttribute("bake_animations", &bake_animations);
+        world.SetBakeAnimations(bake_animations);
+        world_element->QueryFloatAttribute("bake_tolerance", &world.GetBakeTolerance());
+
         const auto window_element = world_element->FirstChildElement("window");
         EARLY_RETURN_FALSE(!window_element, "World XML file is missing the window element.")
 
@@ -428,6 +461,22 @@ namespace world::serde
                     const Vec3f &axis = std::get<transform::RotationWithTime>(transform).axis;
                     XmlSetVec3fAttribute(rotate_element, axis);
                 }
+                else if (std::holds_alternative<transform::KeplerOrbit>(transform))
+                {
+                    const auto &orbit = std::get<transform::KeplerOrbit>(transform);
+                    tinyxml2::XMLElement *orbit_element = doc.NewElement("orbit");
+                    transform_element->InsertEndChild(orbit_element);
+
+                    orbit_element->SetAttribute("time", orbit.time_to_complete);
+                    orbit_element->SetAttribute("semi_major_axis", orbit.semi_major_axis);
+                    orbit_element->SetAttribute("eccentricity", orbit.eccentricity);
+                    orbit_element->SetAttribute("inclination", radians_to_degrees(orbit.inclination_rads));
+                    orbit_element->SetAttribute("ascending_node", radians_to_degrees(orbit.ascending_node_rads));
+                    orbit_element->SetAttribute(
+                        "periapsis_argument", radians_to_degrees(orbit.periapsis_argument_rads)
+                    );
+                    orbit_element->SetAttribute("mean_anomaly", radians_to_degrees(orbit.mean_anomaly_at_epoch_rads));
+                }
                 else if (std::holds_alternative<transform::TranslationThroughPoints>(transform))
                 {
                     const auto translation = std::get<transform::TranslationThroughPoints>(transform);
@@ -436,6 +485,8 @@ namespace world::serde
 
                     translate_element->SetAttribute("time", translation.time_to_complete);
                     translate_element->SetAttribute("align", translation.align_to_path);
+                    if (translation.constant_speed)
+                        translate_element->SetAttribute("constant_speed", true);
 
                     for (const auto &point : translation.points_to_follow)
                     {
@@ -459,6 +510,11 @@ namespace world::serde
         tinyxml2::XMLDocument doc;
         tinyxml2::XMLElement *world_element = doc.NewElement("world");
         doc.InsertFirstChild(world_element);
+        if (world.GetBakeAnimations())
+        {
+            world_element->SetAttribute("bake_animations", true);
+            world_element->SetAttribute("bake_tolerance", world.GetBakeTolerance());
+        }
 
         tinyxml2::XMLElement *window_element = doc.NewElement("window");
         window_element->SetAttribute("width", world.GetWindow().width);
@@ -1,5 +1,6 @@
 #include "Engine.h"
 
+#include <chrono>
 #include <iostream>
 
 #include "Frustum.h"
@@ -7,6 +8,71 @@
 
 namespace engine
 {
+    namespace
+    {
+        const Color PATH_COLOR(1.0f, 0.7f, 0.0f);
+        const Color LIGHT_MODEL_COLOR(1.0f, 1.0f, 0.5f);
+
+        // The 12 edges of bounds, as pairs of GL_LINES vertexes
+        void addBoxLines(const AABB &bounds, std::vector<Vec3f> &lines)
+        {
+            const Vec3f &a = bounds.min, &b = bounds.max;
+            const Vec3f corners[8] = {
+                {a.x, a.y, a.z},
+                {b.x, a.y, a.z},
+                {b.x, b.y, a.z},
+                {a.x, b.y, a.z},
+                {a.x, a.y, b.z},
+                {b.x, a.y, b.z},
+                {b.x, b.y, b.z},
+                {a.x, b.y, b.z},
+            };
+            for (int i = 0; i < 4; ++i)
+            {
+                // Around the face at min.z, around the face at max.z, and between them
+                lines.push_back(corners[i]);
+                lines.push_back(corners[(i + 1) % 4]);
+                lines.push_back(corners[i + 4]);
+                lines.push_back(corners[(i + 1) % 4 + 4]);
+                lines.push_back(corners[i]);
+                lines.push_back(corners[i + 4]);
+            }
+        }
+
+        // A line along the normal of every vertex of model, one unit long in the space of the model
+        void addNormalLines(model::Model &model, const Mat3x4f &transform, std::vector<Vec3f> &lines)
+        {
+            const auto &vertexes = model.GetVertex();
+            const auto &normals = model.GetNormals();
+            for (size_t i = 0; i < vertexes.size() && i < normals.size(); ++i)
+            {
+                lines.push_back(transform.TransformPoint(vertexes[i]));
+                lines.push_back(transform.TransformPoint(vertexes[i] + normals[i]));
+            }
+        }
+
+        void addLightModel(const world::lighting::Light &light, std::vector<Vec3f> &points, std::vector<Vec3f> &lines)
+        {
+            if (std::holds_alternative<world::lighting::DirectionalLight>(light))
+            {
+                const auto &directional_light = std::get<world::lighting::DirectionalLight>(light);
+                lines.push_back(Vec3f(0.0f));
+                lines.push_back(directional_light.dir * 1000);
+            }
+            else if (std::holds_alternative<world::lighting::PointLight>(light))
+            {
+                points.push_back(std::get<world::lighting::PointLight>(light).pos);
+            }
+            else if (std::holds_alternative<world::lighting::Spotlight>(light))
+            {
+                const auto &spot_light = std::get<world::lighting::Spotlight>(light);
+                points.push_back(spot_light.pos);
+                lines.push_back(spot_light.pos);
+                lines.push_back(spot_light.pos + spot_light.dir.Normalize());
+            }
+        }
+    } // namespace
+
     void glfwErrorCallback(const int error, const char *description)
     {
         fprintf(stderr, "GLFW Error %d: %s\n", error, description);
@@ -34,9 +100,29 @@ namespace engine
             std::cerr << "Failed to load world from xml" << std::endl;
             return false;
         }
+
+        m_scene_dirty = true;
+        m_removed_transform_products = world::CompileTransforms(m_world.GetParentWorldGroup());
+        std::cout << "Transforms compiled, " << m_removed_transform_products << " matrix products per frame removed"
+                  << std::endl;
+
+        if (m_world.GetBakeAnimations())
+            bakeAnimations();
         return true;
     }
 
+    void Engine::bakeAnimations()
+    {
+        m_bake_stats = {};
+        world::BakeTransforms(m_world.GetParentWorldGroup(), m_world.GetBakeTolerance(), m_bake_stats);
+        m_spline_batch_dirty = true;
+
+        std::cout << "Animations baked, " << m_bake_stats.baked_groups << " groups in " << m_bake_stats.keys
+                  << " keys (" << m_bake_stats.bytes << " bytes), max error " << m_bake_stats.max_error << ". "
+                  << m_bake_stats.not_periodic_groups << " groups not periodic, " << m_bake_stats.over_tolerance_groups
+                  << " over the tolerance of " << m_world.GetBakeTolerance() << "." << std::endl;
+    }
+
     bool Engine::loadTextures()
     {
         m_textures.clear();
@@ -56,7 +142,9 @@ namespace engine
 
     bool Engine::loadModels()
     {
+        m_scene_dirty = true;
         m_models.clear();
+        m_picker.Clear();
         for (const auto &model_name : m_world.GetModelNames())
         {
             std::optional<model::Model> model_optional = model::LoadModelFromFile(model_name);
@@ -181,6 +269,8 @@ namespace engine
         if (!loadWorld())
             return false;
 
+        m_jobs = std::make_unique<JobSystem>(m_settings.job_threads);
+
         m_os = utils::getOS();
 
         const int width = m_world.GetWindow().width;
@@ -250,6 +340,10 @@ namespace engine
 
         setupWorldLights();
 
+        m_stream_buffer.Init();
+        if (!m_instanced_renderer.Init())
+            m_settings.instancing = false;
+
         uploadModelsToGPU();
         uploadTexturesToGPU();
 
@@ -308,226 +402,319 @@ namespace engine
         glMatrixMode(GL_MODELVIEW);
     }
 
-    void Engine::renderModelNormals(model::Model &model) const
+    void Engine::setMaterial(const world::ModelMaterial &material) const
     {
-        StartSectionDisableLighting();
-        glColor3f(0.0f, 0.5f, 1.0f);
-        glBegin(GL_LINES);
-        for (int i = 0; i < model.GetVertex().size(); ++i)
-        {
-            Vec3f vertex = model.GetVertex()[i];
-            Vec3f normal = model.GetNormals()[i];
-            glVertex3f(vertex.x, vertex.y, vertex.z);
-            glVertex3f(vertex.x + normal.x, vertex.y + normal.y, vertex.z + normal.z);
-        }
-        glEnd();
-        glColor3f(1.0f, 1.0f, 1.0f);
-        EndSectionDisableLighting();
+        glMaterialfv(GL_FRONT, GL_AMBIENT, &material.ambient.r);
+        glMaterialfv(GL_FRONT, GL_DIFFUSE, &material.diffuse.r);
+        glMaterialfv(GL_FRONT, GL_SPECULAR, &material.specular.r);
+        glMaterialfv(GL_FRONT, GL_EMISSION, &material.emissive.r);
+        glMaterialf(GL_FRONT, GL_SHININESS, material.shininess);
     }
 
-    void Engine::renderModel(const world::GroupModel &model, const size_t index_count) const
+    void Engine::bindModelBuffers(const size_t model_index) const
     {
-        glMaterialfv(GL_FRONT, GL_AMBIENT, &model.material.ambient.r);
-        glMaterialfv(GL_FRONT, GL_DIFFUSE, &model.material.diffuse.r);
-        glMaterialfv(GL_FRONT, GL_SPECULAR, &model.material.specular.r);
-        glMaterialfv(GL_FRONT, GL_EMISSION, &model.material.emissive.r);
-        glMaterialf(GL_FRONT, GL_SHININESS, model.material.shininess);
-
-        if (model.texture_index.has_value())
-        {
-            glBindTexture(GL_TEXTURE_2D, m_texture_buffers[model.texture_index.value()]);
-        }
-
-        glBindBuffer(GL_ARRAY_BUFFER, m_models_normal_buffers[model.model_index]);
+        glBindBuffer(GL_ARRAY_BUFFER, m_models_normal_buffers[model_index]);
         glNormalPointer(GL_FLOAT, 0, 0);
 
-        glBindBuffer(GL_ARRAY_BUFFER, m_models_vertex_buffers[model.model_index]);
+        glBindBuffer(GL_ARRAY_BUFFER, m_models_vertex_buffers[model_index]);
         glVertexPointer(3, GL_FLOAT, 0, 0);
 
-        glBindBuffer(GL_ARRAY_BUFFER, m_models_tex_coords_buffers[model.model_index]);
+        glBindBuffer(GL_ARRAY_BUFFER, m_models_tex_coords_buffers[model_index]);
         glTexCoordPointer(2, GL_FLOAT, 0, 0);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_models_index_buffers[model.model_index]);
-        glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_models_index_buffers[model_index]);
     }
 
-    void Engine::renderGlobalAABB(AABB &aabb)
+    void Engine::renderStreamedVertexes(
+        const GLenum mode,
+        const std::vector<Vec3f> &vertexes,
+        const Color &color,
+        const Mat3x4f &transform
+    )
     {
+        if (vertexes.empty())
+            return;
+
+        const StreamAllocation allocation = m_stream_buffer.Upload(vertexes.data(), vertexes.size() * sizeof(Vec3f));
         StartSectionDisableLighting();
-        glColor3f(0.2f, 0.6f, 0.8f);
+        // Only positions, the other arrays still point at the buffers of the last model
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
         glPushMatrix();
-        glLoadIdentity();
-        // Very ugly but not sure how to do it better without doing two passes in the groups
-        renderCamera(m_world.GetCamera());
-        glBegin(GL_LINE_LOOP);
-        glVertex3f(aabb.min.x, aabb.min.y, aabb.min.z);
-        glVertex3f(aabb.max.x, aabb.min.y, aabb.min.z);
-        glVertex3f(aabb.max.x, aabb.max.y, aabb.min.z);
-        glVertex3f(aabb.min.x, aabb.max.y, aabb.min.z);
-        glEnd();
-
-        glBegin(GL_LINE_LOOP);
-        glVertex3f(aabb.min.x, aabb.min.y, aabb.max.z);
-        glVertex3f(aabb.max.x, aabb.min.y, aabb.max.z);
-        glVertex3f(aabb.max.x, aabb.max.y, aabb.max.z);
-        glVertex3f(aabb.min.x, aabb.max.y, aabb.max.z);
-        glEnd();
-
-        glBegin(GL_LINES);
-        glVertex3f(aabb.min.x, aabb.min.y, aabb.min.z);
-        glVertex3f(aabb.min.x, aabb.min.y, aabb.max.z);
-
-        glVertex3f(aabb.max.x, aabb.min.y, aabb.min.z);
-        glVertex3f(aabb.max.x, aabb.min.y, aabb.max.z);
-
-        glVertex3f(aabb.max.x, aabb.max.y, aabb.min.z);
-        glVertex3f(aabb.max.x, aabb.max.y, aabb.max.z);
-
-        glVertex3f(aabb.min.x, aabb.max.y, aabb.min.z);
-        glVertex3f(aabb.min.x, aabb.max.y, aabb.max.z);
-        glEnd();
+        glMultMatrixf(transform.Data());
+        glColor3f(color.r, color.g, color.b);
+        glBindBuffer(GL_ARRAY_BUFFER, allocation.buffer);
+        glVertexPointer(3, GL_FLOAT, 0, reinterpret_cast<const void *>(allocation.offset));
+        glDrawArrays(mode, 0, static_cast<GLsizei>(vertexes.size()));
         glColor3f(1.0f, 1.0f, 1.0f);
         glPopMatrix();
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
         EndSectionDisableLighting();
     }
 
-    void Engine::renderGroup(world::WorldGroup &group, const Frustum &frustum, const Mat4f &current_transform)
+    void Engine::renderSceneBounds()
     {
-        glPushMatrix();
+        // The scene is drawn from world space, so the current matrix is the one of the camera
+        m_debug_vertexes.clear();
+        for (size_t instance = 0; instance < m_scene.GetInstanceCount(); ++instance)
+        {
+            if (m_scene.IsInstanceVisible(instance))
+                addBoxLines(m_scene.GetInstanceBounds(instance), m_debug_vertexes);
+        }
+        renderStreamedVertexes(GL_LINES, m_debug_vertexes, Color(0.2f, 0.6f, 0.8f));
+    }
 
-        Mat4f transform_matrix = applyTransformMatrix(group.transformations, m_simulation_time.m_current_time);
-        Mat4f new_transform = current_transform * transform_matrix;
+    void Engine::submitRenderQueue()
+    {
+        // State left by the previous draw, unknown at the start since the debug drawing binds buffers too
+        std::optional<size_t> bound_model;
+        std::optional<uint32_t> bound_texture; // the GL texture, 0 for none
+        std::optional<uint32_t> set_material;
+        auto &stats = m_draw_state_stats;
+        stats = {};
+
+        const auto &packets = m_render_queue.GetPackets();
+        const bool instanced = m_settings.instancing && m_instanced_renderer.IsSupported();
+        if (instanced)
+        {
+            m_instanced_renderer.Upload(packets, m_stream_buffer);
+            m_instanced_renderer.Begin(
+                static_cast<int>(std::min(m_world.getLights().size(), (size_t)8)),
+                m_settings.lighting
+            );
+        }
 
-        for (auto &group_model : group.models)
+        for (const auto &batch : m_render_queue.GetBatches())
         {
-            auto &model = m_models[group_model.model_index];
+            // Every packet of a batch has the state of its first one, so the ones after it skip all of it
+            const auto &first_packet = packets[batch.first];
+            const size_t skipped = batch.count - 1;
+            if (set_material != first_packet.material_index)
+            {
+                setMaterial(m_render_queue.GetMaterials()[first_packet.material_index]);
+                set_material = first_packet.material_index;
+                stats.material_changes++;
+            }
+            else
+            {
+                stats.material_changes_skipped++;
+            }
+            stats.material_changes_skipped += skipped;
 
-            if (m_settings.frustum_culling)
+            const uint32_t texture = first_packet.texture_index ? m_texture_buffers[*first_packet.texture_index] : 0;
+            if (bound_texture != texture)
             {
-                AABB global_aabb = model.GetAABB().Transform(new_transform);
-                if (!frustum.HasInside(global_aabb))
-                    continue;
+                glBindTexture(GL_TEXTURE_2D, texture);
+                bound_texture = texture;
+                stats.texture_binds++;
+            }
+            else
+            {
+                stats.texture_binds_skipped++;
+            }
+            stats.texture_binds_skipped += skipped;
 
-                if (m_settings.render_aabb)
-                    renderGlobalAABB(global_aabb);
+            if (bound_model != first_packet.model_index)
+            {
+                bindModelBuffers(first_packet.model_index);
+                bound_model = first_packet.model_index;
+                stats.model_binds++;
+            }
+            else
+            {
+                stats.model_binds_skipped++;
             }
+            stats.model_binds_skipped += skipped;
 
-            auto model_index_size = model.GetIndexes().size();
-            renderModel(group_model, model_index_size);
-            if (m_settings.render_normals)
-                renderModelNormals(model);
+            stats.batches++;
+            if (instanced)
+            {
+                m_instanced_renderer.SetTextured(texture != 0);
+                m_instanced_renderer.Draw(batch, first_packet.index_count);
+                stats.instances += batch.count;
+                stats.draws++;
+                continue;
+            }
 
-            m_current_rendered_models_size += 1;
-            m_current_rendered_indexes_size += model_index_size;
+            for (size_t i = batch.first; i < batch.first + batch.count; ++i)
+            {
+                glPushMatrix();
+                glMultMatrixf(packets[i].transform.Data());
+                glDrawElements(GL_TRIANGLES, packets[i].index_count, GL_UNSIGNED_INT, 0);
+                glPopMatrix();
+                stats.draws++;
+            }
         }
+        if (instanced)
+            m_instanced_renderer.End();
+        glBindTexture(GL_TEXTURE_2D, 0);
 
-        for (auto &child : group.children)
+        if (m_settings.render_normals)
         {
-            renderGroup(child, frustum, new_transform);
+            // In world space, so all of them are one draw, without the texture of the model
+            m_debug_vertexes.clear();
+            for (const auto &packet : packets)
+                addNormalLines(m_models[packet.model_index], packet.transform, m_debug_vertexes);
+            renderStreamedVertexes(GL_LINES, m_debug_vertexes, Color(0.0f, 0.5f, 1.0f));
         }
 
-        glPopMatrix();
+        m_current_rendered_models_size = packets.size();
+        m_current_rendered_indexes_size = m_render_queue.GetIndexCount();
     }
 
-    Mat4f Engine::applyTransformMatrix(world::GroupTransform &transformations, float time)
+    void Engine::renderScenePaths()
     {
-        Mat4f result = Mat4fIdentity;
-        for (auto &transformation : transformations.GetTransformations())
+        if (!m_settings.render_transform_through_points_path)
+            return;
+
+        const float time = m_simulation_time.m_current_time;
+        for (size_t node = 0; node < m_scene.GetNodeCount(); ++node)
+        {
+            auto &transformations = m_scene.GetGroup(node).transformations;
+            // Paths and orbits are time dependent, the other groups have nothing to draw
+            if (!transformations.IsTimeDependent())
+                continue;
+
+            const Mat3x4f &parent_transform = m_scene.GetParentTransform(node);
+            transformations.Evaluate(
+                time,
+                [&](world::transform::TranslationThroughPoints &translation, const Mat3x4f &previous)
+                {
+                    renderCatmullRomCurves(translation, parent_transform * previous);
+                    return translation.GetTransform(time);
+                },
+                [&](world::transform::KeplerOrbit &orbit, const Mat3x4f &previous)
+                {
+                    renderKeplerOrbit(orbit, parent_transform * previous);
+                    return orbit.GetPosition(time);
+                }
+            );
+        }
+    }
+
+    void Engine::updateSplineBatch()
+    {
+        if (m_spline_batch_dirty || m_spline_batch_reads != m_spline_batch.Size())
         {
-            Mat4f matrix = std::visit([&](auto &&arg) { return arg.GetTransform(time); }, transformation);
-            if (std::holds_alternative<world::transform::TranslationThroughPoints>(transformation))
+            m_spline_batch.Clear();
+            m_spline_batch_paths.clear();
+            addToSplineBatch(m_world.GetParentWorldGroup());
+            m_spline_batch_dirty = false;
+        }
+
+        m_spline_batch.Evaluate(m_simulation_time.m_current_time);
+        m_spline_batch_reads = 0;
+    }
+
+    void Engine::addToSplineBatch(world::WorldGroup &group)
+    {
+        // The paths of a baked group were only evaluated by the bake
+        if (!usesBakedTransform(group.transformations))
+        {
+            for (auto &transformation : group.transformations.GetTransformations())
             {
+                if (!std::holds_alternative<world::transform::TranslationThroughPoints>(transformation))
+                    continue;
+
                 auto &translation = std::get<world::transform::TranslationThroughPoints>(transformation);
-                renderCatmullRomCurves(translation);
+                translation.batch_dirty = translation.points_to_follow.size() < 4;
+                if (translation.batch_dirty)
+                    continue;
+
+                translation.batch_index = m_spline_batch.Add(translation.getSpline(), translation.time_to_complete);
+                m_spline_batch_paths.push_back(&translation);
             }
+        }
 
-            glMultMatrixf(*matrix.transpose().mat);
-            result *= matrix;
+        for (auto &child : group.children)
+        {
+            addToSplineBatch(child);
         }
-        return result;
     }
 
-    void Engine::renderCatmullRomCurves(world::transform::TranslationThroughPoints &translation) const
+    Mat3x4f Engine::getPathTransform(world::transform::TranslationThroughPoints &translation, const float time)
+    {
+        const bool batched = !translation.batch_dirty && translation.batch_index < m_spline_batch_paths.size() &&
+            m_spline_batch_paths[translation.batch_index] == &translation;
+        if (!batched)
+        {
+            // Added, moved or edited after the batch was built, which is rebuilt on the next frame
+            if (translation.points_to_follow.size() >= 4)
+                m_spline_batch_dirty = true;
+            return translation.GetTransform(time);
+        }
+
+        m_spline_batch_reads.fetch_add(1, std::memory_order_relaxed);
+        return translation.GetTransform(
+            time,
+            m_spline_batch.GetPosition(translation.batch_index),
+            m_spline_batch.GetDerivative(translation.batch_index)
+        );
+    }
+
+    Mat3x4f Engine::evaluateTransform(world::GroupTransform &transformations, const float time)
+    {
+        if (usesBakedTransform(transformations))
+            return transformations.GetBaked()->Evaluate(time);
+
+        return transformations.Evaluate(
+            time,
+            [&](world::transform::TranslationThroughPoints &translation, const Mat3x4f &)
+            { return getPathTransform(translation, time); },
+            [&](world::transform::KeplerOrbit &orbit, const Mat3x4f &) { return orbit.GetPosition(time); }
+        );
+    }
+
+    void Engine::renderCatmullRomCurves(
+        world::transform::TranslationThroughPoints &translation,
+        const Mat3x4f &transform
+    )
     {
         if (!m_settings.render_transform_through_points_path || !translation.render_path ||
             translation.points_to_follow.size() < 4)
             return;
 
-        if (translation.render_path_gpu_buffer == 0)
-            glGenBuffers(1, &translation.render_path_gpu_buffer);
-
         constexpr size_t NUM_SEGMENTS = 100;
         if (translation.render_path_dirty)
         {
-
-            std::vector<Vec3f> vertex;
+            const auto &spline = translation.getSpline();
+            auto &vertex = translation.render_path_vertexes;
+            vertex.clear();
             for (int i = 0; i < NUM_SEGMENTS; ++i)
             {
                 const float time = static_cast<float>(i) / static_cast<float>(NUM_SEGMENTS);
                 Vec3f position, derivative;
-                getCatmullRomPoint(time, translation.points_to_follow, position, derivative);
+                spline.Evaluate(time, position, derivative);
                 vertex.push_back(position);
             }
 
-            glBindBuffer(GL_ARRAY_BUFFER, translation.render_path_gpu_buffer);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(Vec3f) * vertex.size(), vertex.data(), GL_STATIC_DRAW);
             translation.render_path_dirty = false;
         }
-        StartSectionDisableLighting();
-        glColor3f(1.0f, 0.7f, 0.0f);
-        glBindBuffer(GL_ARRAY_BUFFER, translation.render_path_gpu_buffer);
-        glVertexPointer(3, GL_FLOAT, 0, 0);
-        glDrawArrays(GL_LINE_LOOP, 0, NUM_SEGMENTS);
-        glColor3f(1.0f, 1.0f, 1.0f);
-        EndSectionDisableLighting();
+        renderStreamedVertexes(GL_LINE_LOOP, translation.render_path_vertexes, PATH_COLOR, transform);
     }
 
-    void Engine::renderLightModel(const world::lighting::Light &light) const
+    void Engine::renderKeplerOrbit(world::transform::KeplerOrbit &orbit, const Mat3x4f &transform)
     {
-        StartSectionDisableLighting();
-        if (std::holds_alternative<world::lighting::DirectionalLight>(light))
-        {
-            const auto &directional_light = std::get<world::lighting::DirectionalLight>(light);
-            Vec3f dir = directional_light.dir;
-
-            glColor3f(1.0f, 1.0f, 0.5f);
-            glBegin(GL_LINES);
-            glVertex3f(0.0f, 0.0f, 0.0f);
-            glVertex3f(dir.x * 1000, dir.y * 1000, dir.z * 1000);
-            glColor3f(1.0f, 1.0f, 1.0f);
-            glEnd();
-        }
-        else if (std::holds_alternative<world::lighting::PointLight>(light))
-        {
-            const auto &point_light = std::get<world::lighting::PointLight>(light);
-            Vec3f pos = point_light.pos;
-
-            glPointSize(10.0f);
-            glColor3f(1.0f, 1.0f, 0.5f);
-            glBegin(GL_POINTS);
-            glVertex3f(pos.x, pos.y, pos.z);
-            glColor3f(1.0f, 1.0f, 1.0f);
-            glEnd();
-        }
-        else if (std::holds_alternative<world::lighting::Spotlight>(light))
-        {
-            const auto &spot_light = std::get<world::lighting::Spotlight>(light);
-            Vec3f pos = spot_light.pos;
-            Vec3f dir = spot_light.dir.Normalize();
-
-            glPointSize(10.0f);
-            glColor3f(1.0f, 1.0f, 0.5f);
-            glBegin(GL_POINTS);
-            glVertex3f(pos.x, pos.y, pos.z);
-            glEnd();
-            glBegin(GL_LINES);
-            glVertex3f(pos.x, pos.y, pos.z);
-            glVertex3f(pos.x + dir.x, pos.y + dir.y, pos.z + dir.z);
-            glEnd();
-            glColor3f(1.0f, 1.0f, 1.0f);
+        if (!m_settings.render_transform_through_points_path || !orbit.render_path)
+            return;
+
+        constexpr size_t NUM_SEGMENTS = 100;
+        if (orbit.render_path_dirty)
+        {
+            // Evenly spaced in eccentric anomaly, which needs no Kepler solve and keeps the ends of the ellipse smooth
+            const auto &ellipse = orbit.getEllipse();
+            auto &vertex = orbit.render_path_vertexes;
+            vertex.clear();
+            for (int i = 0; i < NUM_SEGMENTS; ++i)
+            {
+                const float eccentric_anomaly = static_cast<float>(i) / static_cast<float>(NUM_SEGMENTS) * M_PI * 2;
+                vertex.push_back(ellipse.PositionAtEccentricAnomaly(eccentric_anomaly));
+            }
+
+            orbit.render_path_dirty = false;
         }
-        EndSectionDisableLighting();
+        renderStreamedVertexes(GL_LINE_LOOP, orbit.render_path_vertexes, PATH_COLOR, transform);
     }
 
     void Engine::setupWorldLights()
@@ -554,6 +741,7 @@ namespace engine
     {
         const auto &lights = m_world.getLights();
         const auto light_count = std::min(lights.size(), (size_t)8);
+        std::vector<Vec3f> light_points, light_lines;
         for (int i = 0; i < light_count; ++i)
         {
             const auto &light = lights[i];
@@ -582,8 +770,14 @@ namespace engine
                 glLightf(GL_LIGHT0 + i, GL_SPOT_CUTOFF, spot_light.cutoff);
             }
             if (m_settings.render_light_models)
-                renderLightModel(light);
+                addLightModel(light, light_points, light_lines);
         }
+
+        if (!m_settings.render_light_models)
+            return;
+        glPointSize(10.0f);
+        renderStreamedVertexes(GL_POINTS, light_points, LIGHT_MODEL_COLOR);
+        renderStreamedVertexes(GL_LINES, light_lines, LIGHT_MODEL_COLOR);
     }
 
     Frustum Engine::getCurrentFrustum()
@@ -599,6 +793,35 @@ namespace engine
         );
     }
 
+    void Engine::pickAtCursor(const double x, const double y)
+    {
+        // The scene is the one of the last frame, what is on the screen, unless it is about to be rebuilt
+        if (m_scene_dirty)
+            return;
+
+        const auto &camera = m_world.GetCamera();
+        auto &window = m_world.GetWindow();
+        const Ray ray = CreateRayFromCamera(
+            camera.position,
+            camera.looking_at,
+            camera.up,
+            camera.fov,
+            window.getAspectRatio(),
+            Vec2f{static_cast<float>(x), static_cast<float>(y)},
+            Vec2f{static_cast<float>(window.width), static_cast<float>(window.height)}
+        );
+        const auto pick_start = std::chrono::steady_clock::now();
+        const auto hit = m_picker.Pick(m_scene, m_models, ray);
+        m_pick_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - pick_start).count();
+
+        m_picked_groups.clear();
+        if (!hit.has_value())
+            return;
+        for (const uint32_t node : hit->path)
+            m_picked_groups.push_back(&m_scene.GetGroup(node));
+        m_reveal_pick = true;
+    }
+
     void Engine::Render()
     {
         renderImGui();
@@ -613,16 +836,42 @@ namespace engine
 
         glLoadIdentity();
 
+        m_stream_buffer.BeginFrame();
         renderCamera(m_world.GetCamera());
         renderLights();
 
         if (m_settings.render_axis)
             renderAxis();
 
-        m_current_rendered_models_size = 0;
-        m_current_rendered_indexes_size = 0;
-
-        renderGroup(m_world.GetParentWorldGroup(), getCurrentFrustum(), Mat4fIdentity);
+        if (m_scene_dirty)
+        {
+            m_scene.Build(m_world.GetParentWorldGroup(), m_models);
+            m_scene_dirty = false;
+            m_picked_groups.clear();
+        }
+        updateSplineBatch();
+        const auto update_start = std::chrono::steady_clock::now();
+        const float time = m_simulation_time.m_current_time;
+        m_scene.Update(
+            *m_jobs,
+            [&](world::GroupTransform &transformations) { return evaluateTransform(transformations, time); }
+        );
+        if (m_settings.frustum_culling && m_settings.group_culling)
+            m_scene.CullGroups(getCurrentFrustum(), *m_jobs);
+        else if (m_settings.frustum_culling)
+            m_scene.Cull(getCurrentFrustum(), *m_jobs);
+        m_render_queue.Collect(m_scene, m_settings.frustum_culling);
+        if (m_settings.sort_draws)
+            m_render_queue.Sort();
+        m_render_queue.Batch();
+        m_scene_update_ms =
+            std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - update_start).count();
+
+        renderScenePaths();
+        if (m_settings.frustum_culling && m_settings.render_aabb)
+            renderSceneBounds();
+        submitRenderQueue();
+        m_stream_buffer.EndFrame();
 
         postRenderImGui();
     }
@@ -820,6 +1069,11 @@ namespace engine
             m_input.UpdateButton(m_window, GLFW_MOUSE_BUTTON_LEFT);
             m_input.UpdateButton(m_window, GLFW_MOUSE_BUTTON_RIGHT);
 
+            if (m_input.IsPressEvent(GLFW_MOUSE_BUTTON_RIGHT))
+            {
+                pickAtCursor(xpos, ypos);
+            }
+
             if (m_input.IsPressEvent(GLFW_MOUSE_BUTTON_LEFT))
             {
                 glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -6,9 +6,20 @@
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
 #include "Frustum.h"
 #include "Input.h"
+#include "InstancedRenderer.h"
 #include "Model.h"
+#include "Picking.h"
+#include "RenderQueue.h"
+#include "Scene.h"
+#include "SplineBatch.h"
+#include "StreamBuffer.h"
 #include "Utils.h"
 #include "World.h"
 
@@ -40,6 +51,12 @@ namespace engine
         bool render_light_models = false;
         bool render_aabb = false;
         bool frustum_culling = true;
+        // Walking the bounds of the group tree instead of testing every instance, see Scene::CullGroups
+        bool group_culling = false;
+        bool sort_draws = true; // by their state, so consecutive draws skip binding the same model and texture
+        bool instancing = true; // one instanced draw per batch of draws with the same state, if the GL supports it
+        // Threads updating and culling the scene, the render thread included
+        size_t job_threads = std::max(std::thread::hardware_concurrency(), 1u);
         bool fullscreen = false;
         Color background_color = Color(0.0f, 0.0f, 0.0f, 1.0f);
     };
@@ -102,6 +119,33 @@ namespace engine
 
         size_t m_current_rendered_models_size = 0;
         size_t m_current_rendered_indexes_size = 0;
+        size_t m_removed_transform_products = 0; // by compiling the transforms of the world when it was loaded
+        world::BakeStats m_bake_stats = {}; // of the last bake, if the world bakes animations
+
+        // The world flattened for rendering, built again before the next frame when m_scene_dirty
+        Scene m_scene;
+        bool m_scene_dirty = true;
+        std::unique_ptr<JobSystem> m_jobs; // with m_settings.job_threads threads
+        float m_scene_update_ms = 0; // of Scene::Update, Scene::Cull and the RenderQueue in the last frame
+        RenderQueue m_render_queue; // draws of the frame, collected from m_scene before any of them is submitted
+        DrawStateStats m_draw_state_stats = {}; // of the last submission of m_render_queue
+        InstancedRenderer m_instanced_renderer;
+        // Data uploaded every frame: the instance transforms and the debug drawing
+        StreamBuffer m_stream_buffer;
+        std::vector<Vec3f> m_debug_vertexes; // of the bounds or normals, kept to reuse its capacity
+
+        // Right click picking of the model under the cursor
+        Picker m_picker;
+        std::vector<const world::WorldGroup *> m_picked_groups; // from the root down to the picked group, or empty
+        bool m_reveal_pick = false; // opens the ImGui group tree down to the picked group in the next frame
+        float m_pick_ms = 0; // of the last Picker::Pick
+
+        // Every TranslationThroughPoints of the world, evaluated at once at the start of the frame
+        SplineBatch m_spline_batch;
+        std::vector<const world::transform::TranslationThroughPoints *> m_spline_batch_paths; // to detect moved paths
+        // Paths that read the batch in the last frame, fewer if some were removed. Read from every job thread.
+        std::atomic<size_t> m_spline_batch_reads = 0;
+        std::atomic<bool> m_spline_batch_dirty = true;
 
         void setupEnvironment();
 
@@ -115,14 +159,34 @@ namespace engine
             size_t world_group_index,
             world::WorldGroup *parent_group = nullptr
         );
-        Mat4f applyTransformMatrix(world::GroupTransform &transformations, float time);
-        void renderCatmullRomCurves(world::transform::TranslationThroughPoints &translation) const;
-        void renderGroup(world::WorldGroup &group, const Frustum &frustum, const Mat4f &current_transform);
-        void renderModel(const world::GroupModel &model, size_t index_count) const;
-        void renderModelNormals(model::Model &model) const;
+        void bakeAnimations();
+        // Baked tables skip the paths, which aren't drawn then
+        bool usesBakedTransform(const world::GroupTransform &transformations) const
+        {
+            return transformations.GetBaked() && !m_settings.render_transform_through_points_path;
+        }
+        void updateSplineBatch();
+        void addToSplineBatch(world::WorldGroup &group);
+        Mat3x4f getPathTransform(world::transform::TranslationThroughPoints &translation, float time);
+        Mat3x4f evaluateTransform(world::GroupTransform &transformations, float time);
+        // transform is the world transform of the path, the product of its parents and the transforms before it
+        void renderCatmullRomCurves(world::transform::TranslationThroughPoints &translation, const Mat3x4f &transform);
+        void renderKeplerOrbit(world::transform::KeplerOrbit &orbit, const Mat3x4f &transform);
+        // Uploads vertexes to the stream buffer and draws them in color, without lighting
+        void renderStreamedVertexes(
+            GLenum mode,
+            const std::vector<Vec3f> &vertexes,
+            const Color &color,
+            const Mat3x4f &transform = Mat3x4fIdentity
+        );
+        void renderSceneBounds();
+        void submitRenderQueue();
+        void renderScenePaths();
+        void setMaterial(const world::ModelMaterial &material) const;
+        void bindModelBuffers(size_t model_index) const;
         void renderLights();
-        void renderLightModel(const world::lighting::Light &light) const;
-        void renderGlobalAABB(AABB &aabb);
+        // x and y in window coordinates, like the GLFW cursor
+        void pickAtCursor(double x, double y);
 
         bool loadWorld();
         bool loadModels();
@@ -46,6 +46,8 @@ namespace engine
             return "Translation Through Points";
         if (std::holds_alternative<world::transform::RotationWithTime>(transform))
             return "Rotation with Time";
+        if (std::holds_alternative<world::transform::KeplerOrbit>(transform))
+            return "Kepler Orbit";
         return "Unknown";
     }
 
@@ -57,7 +59,20 @@ namespace engine
     {
         auto &model_indexes = world_group.models;
         const auto world_group_name = world_group.name.has_value() ? world_group.name->c_str() : "unknown";
+        const bool on_picked_path = std::ranges::find(m_picked_groups, &world_group) != m_picked_groups.end();
+        if (on_picked_path && m_reveal_pick)
+            ImGui::SetNextItemOpen(true);
         const auto opened = ImGui::TreeNode(&world_group, "Group (%s)", world_group_name);
+        if (!m_picked_groups.empty() && m_picked_groups.back() == &world_group)
+        {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "(picked)");
+            if (m_reveal_pick)
+            {
+                ImGui::SetScrollHereY();
+                m_reveal_pick = false;
+            }
+        }
         if (parent_group != nullptr)
         {
             ImGui::PushID(&world_group);
@@ -65,6 +80,7 @@ namespace engine
             if (ImGui::SmallButton("Remove"))
             {
                 parent_group->children.erase(parent_group->children.begin() + world_group_index);
+                m_scene_dirty = true;
             }
             ImGui::PopID();
         }
@@ -87,6 +103,7 @@ namespace engine
                             group_model.model_index = i;
                             group_model.texture_index = std::nullopt;
                             model_indexes.push_back(group_model);
+                            m_scene_dirty = true;
                             break;
                         }
                     }
@@ -103,6 +120,7 @@ namespace engine
                     if (ImGui::SmallButton("Remove"))
                     {
                         model_indexes.erase(model_indexes.begin() + i);
+                        m_scene_dirty = true;
                     }
 
                     auto &texture_index = group_model.texture_index;
@@ -197,6 +215,12 @@ namespace engine
                         ImGui::CloseCurrentPopup();
                     }
 
+                    if (ImGui::MenuItem("Kepler Orbit"))
+                    {
+                        world_group.transformations.AddTransform(world::transform::KeplerOrbit());
+                        ImGui::CloseCurrentPopup();
+                    }
+
                     if (ImGui::MenuItem("Scale"))
                     {
                         world_group.transformations.AddTransform(world::transform::Scale());
@@ -237,33 +261,60 @@ namespace engine
                     {
                         auto &rotation = std::get<world::transform::Rotation>(transform);
                         float angle = radians_to_degrees(rotation.angle_rads);
-                        ImGui::DragFloat3("Axis", &rotation.axis.x, 0.05f);
+                        if (ImGui::DragFloat3("Axis", &rotation.axis.x, 0.05f))
+                        {
+                            world_group.transformations.MarkDirty();
+                        }
 
                         if (ImGui::DragFloat("Angle", &angle, 1, -360.0f, 360.0f))
                         {
                             rotation.angle_rads = degrees_to_radians(angle);
+                            world_group.transformations.MarkDirty();
                         }
                     }
                     else if (std::holds_alternative<world::transform::RotationWithTime>(transform))
                     {
                         auto &rotation_with_time = std::get<world::transform::RotationWithTime>(transform);
-                        ImGui::DragFloat3("Axis", &rotation_with_time.axis.x, 0.05f);
-                        ImGui::DragFloat(
-                            "Time to 360º", &rotation_with_time.time_to_complete, 0.01f, 0.0f, 0.0f, "%.3f s"
-                        );
+                        if (ImGui::DragFloat3("Axis", &rotation_with_time.axis.x, 0.05f))
+                        {
+                            rotation_with_time.updateRotation();
+                            world_group.transformations.MarkDirty();
+                        }
+                        if (ImGui::DragFloat(
+                                "Time to 360º", &rotation_with_time.time_to_complete, 0.01f, 0.0f, 0.0f, "%.3f s"
+                            ))
+                        {
+                            rotation_with_time.updateRotation();
+                            world_group.transformations.MarkDirty();
+                        }
                     }
                     else if (std::holds_alternative<world::transform::Translation>(transform))
                     {
                         auto &translation = std::get<world::transform::Translation>(transform);
-                        ImGui::DragFloat3("Coordinates", &translation.translation.x, 0.05f);
+                        if (ImGui::DragFloat3("Coordinates", &translation.translation.x, 0.05f))
+                        {
+                            world_group.transformations.MarkDirty();
+                        }
                     }
                     else if (std::holds_alternative<world::transform::TranslationThroughPoints>(transform))
                     {
                         auto &translation = std::get<world::transform::TranslationThroughPoints>(transform);
-                        ImGui::DragFloat(
-                            "Time to Complete", &translation.time_to_complete, 0.01f, 0.0f, 0.0f, "%.3f s"
-                        );
-                        ImGui::Checkbox("Align to Path", &translation.align_to_path);
+                        if (ImGui::DragFloat(
+                                "Time to Complete", &translation.time_to_complete, 0.01f, 0.0f, 0.0f, "%.3f s"
+                            ))
+                        {
+                            translation.batch_dirty = true;
+                            world_group.transformations.MarkDirty();
+                        }
+                        if (ImGui::Checkbox("Align to Path", &translation.align_to_path))
+                        {
+                            world_group.transformations.MarkDirty();
+                        }
+                        if (ImGui::Checkbox("Constant Speed", &translation.constant_speed))
+                        {
+                            translation.updatePoints();
+                            world_group.transformations.MarkDirty();
+                        }
                         ImGui::Checkbox("Render Path", &translation.render_path);
 
                         if (!m_settings.render_transform_through_points_path)
@@ -289,12 +340,14 @@ namespace engine
                             if (ImGui::DragFloat3(name.c_str(), &point_to_follow.x, 0.05f))
                             {
                                 translation.updatePoints();
+                                world_group.transformations.MarkDirty();
                             }
                             ImGui::SameLine();
                             if (ImGui::SmallButton("Remove"))
                             {
                                 translation.points_to_follow.erase(translation.points_to_follow.begin() + point_index);
                                 translation.updatePoints();
+                                world_group.transformations.MarkDirty();
                             }
                             ImGui::PopID();
                         }
@@ -303,12 +356,62 @@ namespace engine
                         {
                             translation.points_to_follow.push_back(Vec3f{});
                             translation.updatePoints();
+                            world_group.transformations.MarkDirty();
+                        }
+                    }
+                    else if (std::holds_alternative<world::transform::KeplerOrbit>(transform))
+                    {
+                        auto &orbit = std::get<world::transform::KeplerOrbit>(transform);
+                        const auto update_orbit = [&]
+                        {
+                            orbit.updateOrbit();
+                            world_group.transformations.MarkDirty();
+                        };
+                        const auto drag_angle = [&](const char *label, float &angle_rads)
+                        {
+                            float angle = radians_to_degrees(angle_rads);
+                            if (ImGui::DragFloat(label, &angle, 1, -360.0f, 360.0f))
+                            {
+                                angle_rads = degrees_to_radians(angle);
+                                update_orbit();
+                            }
+                        };
+
+                        if (ImGui::DragFloat(
+                                "Orbital Period", &orbit.time_to_complete, 0.01f, 0.0f, 0.0f, "%.3f s"
+                            ))
+                        {
+                            world_group.transformations.MarkDirty();
+                        }
+                        if (ImGui::DragFloat("Semi-major Axis", &orbit.semi_major_axis, 0.05f))
+                        {
+                            update_orbit();
+                        }
+                        if (ImGui::DragFloat(
+                                "Eccentricity", &orbit.eccentricity, 0.005f, 0.0f, KEPLER_MAX_ECCENTRICITY
+                            ))
+                        {
+                            update_orbit();
+                        }
+                        drag_angle("Inclination", orbit.inclination_rads);
+                        drag_angle("Ascending Node", orbit.ascending_node_rads);
+                        drag_angle("Periapsis Argument", orbit.periapsis_argument_rads);
+                        drag_angle("Mean Anomaly at Epoch", orbit.mean_anomaly_at_epoch_rads);
+                        ImGui::Checkbox("Render Path", &orbit.render_path);
+
+                        if (!m_settings.render_transform_through_points_path)
+                        {
+                            ImGui::SameLine();
+                            ImGui::TextDisabled("(Disabled on Settings Page)");
                         }
                     }
                     else if (std::holds_alternative<world::transform::Scale>(transform))
                     {
                         auto &scale = std::get<world::transform::Scale>(transform);
-                        ImGui::DragFloat3("Axis", &scale.scale.x, 0.05f);
+                        if (ImGui::DragFloat3("Axis", &scale.scale.x, 0.05f))
+                        {
+                            world_group.transformations.MarkDirty();
+                        }
                     }
                     ImGui::EndGroup();
                     ImGui::PopID();
@@ -327,6 +430,8 @@ namespace engine
                                 auto &origin = target_group_transformations[transform_payload.group_index];
                                 auto &target = world_group.transformations.GetTransformations()[i];
                                 std::swap(origin, target);
+                                transform_payload.group->transformations.MarkDirty();
+                                world_group.transformations.MarkDirty();
                             }
                         }
                         ImGui::EndDragDropTarget();
@@ -358,6 +463,7 @@ namespace engine
             {
                 const auto new_group = world::WorldGroup();
                 world_group.children.push_back(new_group);
+                m_scene_dirty = true;
             }
 
             ImGui::TreePop();
@@ -387,6 +493,8 @@ namespace engine
             ImGui::Begin("CG Engine");
 
             auto flags = ImGuiTreeNodeFlags_Framed | ImGuiTreeNodeFlags_DefaultOpen;
+            if (m_reveal_pick)
+                ImGui::SetNextItemOpen(true);
             if (ImGui::TreeNodeEx(&m_world, flags, "World (%s)", m_world.GetFilePath().c_str()))
             {
                 ImGui::Text("Width:");
@@ -518,6 +626,8 @@ namespace engine
                     ImGui::TreePop();
                 }
 
+                if (m_reveal_pick)
+                    ImGui::SetNextItemOpen(true);
                 if (ImGui::TreeNodeEx("Groups", ImGuiTreeNodeFlags_Framed | ImGuiTreeNodeFlags_DefaultOpen))
                 {
                     renderImGuiWorldGroupMenu(m_world.GetParentWorldGroup(), 0, nullptr);
@@ -685,6 +795,40 @@ namespace engine
             if (ImGui::TreeNodeEx("Simulation", ImGuiTreeNodeFlags_Framed))
             {
                 ImGui::Text("Current Time: %.2f", m_simulation_time.m_current_time);
+                ImGui::Text("Matrix Products Removed: %zu per frame", m_removed_transform_products);
+
+                bool bake_animations = m_world.GetBakeAnimations();
+                if (ImGui::Checkbox("Bake Animations", &bake_animations))
+                {
+                    m_world.SetBakeAnimations(bake_animations);
+                    if (bake_animations)
+                    {
+                        bakeAnimations();
+                    }
+                    else
+                    {
+                        world::ClearBakedTransforms(m_world.GetParentWorldGroup());
+                        m_bake_stats = {};
+                        m_spline_batch_dirty = true;
+                    }
+                }
+                if (m_world.GetBakeAnimations())
+                {
+                    ImGui::DragFloat("Bake Tolerance", &m_world.GetBakeTolerance(), 0.001f, 0.0001f, 10.0f, "%.4f");
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("Rebake"))
+                        bakeAnimations();
+
+                    ImGui::Text(
+                        "Baked: %zu groups, %zu keys, %zu KiB", m_bake_stats.baked_groups, m_bake_stats.keys,
+                        m_bake_stats.bytes / 1024
+                    );
+                    ImGui::Text("Max Error: %.5f", m_bake_stats.max_error);
+                    ImGui::Text(
+                        "Not Baked: %zu not periodic, %zu over tolerance", m_bake_stats.not_periodic_groups,
+                        m_bake_stats.over_tolerance_groups
+                    );
+                }
                 ImGui::Checkbox("Paused", &m_simulation_time.m_is_paused);
                 ImGui::DragFloat("Simulation Speed", &m_simulation_time.m_current_simulation_speed_p_s, 0.05f);
                 ImGui::TreePop();
@@ -756,6 +900,108 @@ namespace engine
                     ))
                 {
                     ImGui::Checkbox("Frustum Culling", &m_settings.frustum_culling);
+                    ImGui::SameLine();
+                    ShowHelpMarker("Tests the bounds of every model instance, unless culling with the groups");
+                    ImGui::Checkbox("Cull with the Groups", &m_settings.group_culling);
+                    ImGui::SameLine();
+                    ShowHelpMarker(
+                        "Walks the bounds of the group tree, culling or accepting the groups completely outside or "
+                        "inside the view with everything below them. Pays off when the groups hold many instances "
+                        "close together, like planets with their moons, not in a flat belt."
+                    );
+                    if (m_settings.group_culling)
+                    {
+                        ImGui::Text(
+                            "Groups culled: %zu tested, %zu skipped with their parent",
+                            m_scene.GetTestedNodes(),
+                            m_scene.GetSkippedNodes()
+                        );
+                    }
+                    ImGui::Text(
+                        "Pick: %.3f ms, %zu bounds, %zu instances and %zu triangles tested",
+                        m_pick_ms,
+                        m_picker.GetTestedNodes(),
+                        m_picker.GetTestedInstances(),
+                        m_picker.GetTestedTriangles()
+                    );
+                    ImGui::SameLine();
+                    ShowHelpMarker("Right click a model to select its group in the World tree");
+                    ImGui::Checkbox("Sort Draws by State", &m_settings.sort_draws);
+                    const auto &draw_stats = m_draw_state_stats;
+                    if (m_instanced_renderer.IsSupported())
+                    {
+                        ImGui::Checkbox("Hardware Instancing", &m_settings.instancing);
+                        ImGui::SameLine();
+                        ShowHelpMarker(
+                            "One draw call per batch of models sharing their model, texture and material, lit by a "
+                            "vertex shader like the fixed pipeline. Sorting the draws makes the batches larger."
+                        );
+                    }
+                    else
+                    {
+                        ImGui::TextDisabled("Hardware Instancing unsupported");
+                    }
+                    ImGui::Text(
+                        "Draw calls: %zu for %zu batches (%zu instanced models)",
+                        draw_stats.draws,
+                        draw_stats.batches,
+                        draw_stats.instances
+                    );
+                    const auto &stream_stats = m_stream_buffer.GetStats();
+                    ImGui::Text(
+                        "Stream buffer: %.2f of %.2f MiB, %zu allocations",
+                        static_cast<float>(stream_stats.used_bytes) / (1 << 20),
+                        static_cast<float>(stream_stats.region_size) / (1 << 20),
+                        stream_stats.allocations
+                    );
+                    ImGui::SameLine();
+                    ShowHelpMarker(
+                        m_stream_buffer.IsPersistent()
+                            ? "Persistently mapped ring of three frames, each waiting on the fence of the frame that "
+                              "used its part three frames ago"
+                            : "No persistent mapping, so the buffer is orphaned every frame"
+                    );
+                    ImGui::Text(
+                        "Stream stalls: %zu (%.3f ms waited), %zu grows",
+                        stream_stats.stalls,
+                        stream_stats.stall_ms,
+                        stream_stats.grows
+                    );
+                    ImGui::Text(
+                        "Model binds: %zu (%zu skipped)",
+                        draw_stats.model_binds,
+                        draw_stats.model_binds_skipped
+                    );
+                    ImGui::Text(
+                        "Texture binds: %zu (%zu skipped)",
+                        draw_stats.texture_binds,
+                        draw_stats.texture_binds_skipped
+                    );
+                    ImGui::Text(
+                        "Material changes: %zu (%zu skipped)",
+                        draw_stats.material_changes,
+                        draw_stats.material_changes_skipped
+                    );
+                    // A model bind is 4 buffer binds and 3 pointers, a material change 5 glMaterial calls
+                    ImGui::Text(
+                        "GL calls avoided: %zu",
+                        draw_stats.model_binds_skipped * 7 + draw_stats.texture_binds_skipped +
+                            draw_stats.material_changes_skipped * 5
+                    );
+
+                    int job_threads = static_cast<int>(m_settings.job_threads);
+                    const int max_job_threads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+                    if (ImGui::SliderInt("Job Threads", &job_threads, 1, max_job_threads))
+                    {
+                        m_settings.job_threads = job_threads;
+                        m_jobs = std::make_unique<JobSystem>(m_settings.job_threads);
+                    }
+                    ImGui::Text(
+                        "Scene update: %.3f ms (%zu jobs stolen)",
+                        m_scene_update_ms,
+                        m_jobs->GetSteals()
+                    );
+                    m_jobs->ResetSteals();
                     ImGui::TreePop();
                 }
 
@@ -776,6 +1022,11 @@ namespace engine
                 m_current_rendered_models_size,
                 m_current_rendered_indexes_size / 3
             );
+            ImGui::Text(
+                "Evaluating %zu of %zu group transforms",
+                m_scene.GetEvaluatedTransforms(),
+                m_scene.GetNodeCount()
+            );
             ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / io->Framerate, io->Framerate);
             ImGui::End();
         }
@@ -41,18 +41,17 @@ void AABB::Extend(Vec3f f)
     max.z = isnan(max.z) ? f.z : std::max(max.z, f.z);
 }
 
-AABB AABB::Transform(Mat4f matrix)
+AABB AABB::Transform(const Mat3x4f &matrix) const
 {
     // Based on https://gist.github.com/cmf028/81e8d3907035640ee0e3fdd69ada543f
     Vec3f center = (max + min) * 0.5;
     Vec3f extents = max - center;
 
     // transform center
-    Vec3f t_center = (matrix * center.ToVec4f(1.0f)).ToVec3f();
+    Vec3f t_center = matrix.TransformPoint(center);
 
     // transform extents (take maximum)
-    Mat4f abs_mat = matrix.Abs();
-    Vec3f t_extents = (abs_mat * extents.ToVec4f(0.0f)).ToVec3f();
+    Vec3f t_extents = matrix.Abs().TransformDirection(extents);
 
     // transform to min/max box representation
     Vec3f tmin = t_center - t_extents;
@@ -66,6 +65,27 @@ AABB AABB::Transform(Mat4f matrix)
     return rbox;
 }
 
+bool AABB::IntersectsRay(
+    const Vec3f &origin,
+    const Vec3f &inverse_direction,
+    const float max_distance,
+    float &distance
+) const
+{
+    float enter = 0, exit = max_distance;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float t1 = (min[axis] - origin[axis]) * inverse_direction[axis];
+        const float t2 = (max[axis] - origin[axis]) * inverse_direction[axis];
+        // With the NaN of an origin on the slab of a parallel ray as t1, std::min and std::max return it and the
+        // outer ones keep enter and exit, as they only take the second value when a comparison with it is true
+        enter = std::max(enter, std::min(t1, t2));
+        exit = std::min(exit, std::max(t1, t2));
+    }
+    distance = enter;
+    return enter <= exit && !std::isnan(min.x);
+}
+
 float Plane::getSignedDistanceToPlane(const Vec3f &point) const { return normal.Dot(point) - distance; }
 
 bool AABB::isOnOrForwardPlane(const Plane &plane) const
@@ -79,9 +99,28 @@ bool AABB::isOnOrForwardPlane(const Plane &plane) const
     return -r <= plane.getSignedDistanceToPlane(center);
 }
 
-bool Frustum::HasInside(AABB &aabb) const
+bool Frustum::HasInside(const AABB &aabb) const
 {
     return aabb.isOnOrForwardPlane(leftFace) && aabb.isOnOrForwardPlane(rightFace) &&
         aabb.isOnOrForwardPlane(topFace) && aabb.isOnOrForwardPlane(bottomFace) && aabb.isOnOrForwardPlane(nearFace) &&
         aabb.isOnOrForwardPlane(farFace);
 }
+
+FrustumTest Frustum::Test(const AABB &aabb) const
+{
+    const Vec3f center = (aabb.max + aabb.min) * 0.5;
+    const Vec3f extents = aabb.max - center;
+
+    FrustumTest result = FrustumTest::INSIDE;
+    for (const Plane *plane : {&leftFace, &rightFace, &topFace, &bottomFace, &nearFace, &farFace})
+    {
+        const float r = extents.x * std::abs(plane->normal.x) + extents.y * std::abs(plane->normal.y) +
+            extents.z * std::abs(plane->normal.z);
+        const float distance = plane->getSignedDistanceToPlane(center);
+        if (distance < -r)
+            return FrustumTest::OUTSIDE;
+        if (distance < r)
+            result = FrustumTest::INTERSECTING;
+    }
+    return result;
+}
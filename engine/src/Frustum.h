@@ -21,10 +21,20 @@ struct AABB
     Vec3f min{NAN};
     Vec3f max{NAN};
     void Extend(Vec3f f);
-    AABB Transform(Mat4f matrix);
+    AABB Transform(const Mat3x4f &matrix) const;
+    // Slab test of the ray origin + t * direction, with inverse_direction = 1 / direction. On a hit before
+    // max_distance, distance is the t where the ray enters the box, or 0 if it starts inside.
+    bool IntersectsRay(const Vec3f &origin, const Vec3f &inverse_direction, float max_distance, float &distance) const;
     bool isOnOrForwardPlane(const Plane &plane) const;
 };
 
+enum class FrustumTest
+{
+    OUTSIDE,
+    INTERSECTING,
+    INSIDE,
+};
+
 struct Frustum
 {
     Plane topFace;
@@ -35,7 +45,9 @@ struct Frustum
 
     Plane farFace;
     Plane nearFace;
-    bool HasInside(AABB &aabb) const;
+    bool HasInside(const AABB &aabb) const;
+    // Like HasInside, but also tells apart the boxes completely inside, whose contents don't need to be tested
+    FrustumTest Test(const AABB &aabb) const;
 };
 
 Frustum CreateFrustumFromCamera(
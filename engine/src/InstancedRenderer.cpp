@@ -0,0 +1,224 @@
+#include "InstancedRenderer.h"
+
+#define GL_SILENCE_DEPRECATION
+#include <GL/glew.h>
+
+#include <iostream>
+#include <string>
+
+namespace
+{
+    static_assert(sizeof(Mat3x4f) == 16 * sizeof(float), "The instance transforms are read as a mat4");
+
+    // GLSL 1.20 reads the fixed-function state: the camera in gl_ModelViewMatrix, the lights in eye space as
+    // glLightfv left them, and the material of glMaterialfv. The lighting is per vertex like the fixed pipeline, with
+    // one color and the viewer at infinity, its defaults.
+    constexpr auto VERTEX_SHADER = R"(
+#version 120
+
+attribute mat4 instance_transform;
+
+uniform int light_count;
+uniform bool lighting;
+
+void main()
+{
+    vec4 position = gl_ModelViewMatrix * (instance_transform * gl_Vertex);
+    gl_Position = gl_ProjectionMatrix * position;
+    gl_TexCoord[0] = gl_MultiTexCoord0;
+
+    if (!lighting)
+    {
+        gl_FrontColor = gl_Color;
+        return;
+    }
+
+    // The cofactors of the instance transform are its inverse transpose times its determinant, which normalize drops
+    // like GL_RESCALE_NORMAL drops the scale
+    vec3 x = instance_transform[0].xyz, y = instance_transform[1].xyz, z = instance_transform[2].xyz;
+    mat3 cofactors = mat3(cross(y, z), cross(z, x), cross(x, y));
+    vec3 normal = normalize(gl_NormalMatrix * (cofactors * gl_Normal) * sign(dot(x, cross(y, z))));
+
+    vec4 color = gl_FrontMaterial.emission + gl_FrontMaterial.ambient * gl_LightModel.ambient;
+    for (int i = 0; i < 8; ++i)
+    {
+        if (i >= light_count)
+            break;
+
+        vec3 to_light = gl_LightSource[i].position.xyz;
+        float attenuation = 1.0;
+        if (gl_LightSource[i].position.w != 0.0)
+        {
+            to_light -= position.xyz;
+            float light_distance = length(to_light);
+            attenuation = 1.0 / (gl_LightSource[i].constantAttenuation +
+                gl_LightSource[i].linearAttenuation * light_distance +
+                gl_LightSource[i].quadraticAttenuation * light_distance * light_distance);
+        }
+        to_light = normalize(to_light);
+
+        if (gl_LightSource[i].spotCutoff != 180.0)
+        {
+            float spot = dot(-to_light, normalize(gl_LightSource[i].spotDirection));
+            attenuation *= spot < gl_LightSource[i].spotCosCutoff ? 0.0 : pow(spot, gl_LightSource[i].spotExponent);
+        }
+
+        float diffuse = max(dot(normal, to_light), 0.0);
+        float specular = 0.0;
+        if (diffuse > 0.0)
+        {
+            vec3 half_vector = normalize(to_light + vec3(0.0, 0.0, 1.0));
+            // pow(0, 0) is undefined, the fixed pipeline takes it as 1
+            float cosine = max(dot(normal, half_vector), 0.0);
+            specular = gl_FrontMaterial.shininess == 0.0 ? 1.0 : pow(cosine, gl_FrontMaterial.shininess);
+        }
+        color += attenuation * (gl_FrontMaterial.ambient * gl_LightSource[i].ambient +
+            diffuse * gl_FrontMaterial.diffuse * gl_LightSource[i].diffuse +
+            specular * gl_FrontMaterial.specular * gl_LightSource[i].specular);
+    }
+    gl_FrontColor = vec4(clamp(color.rgb, 0.0, 1.0), gl_FrontMaterial.diffuse.a);
+}
+)";
+
+    constexpr auto FRAGMENT_SHADER = R"(
+#version 120
+
+uniform sampler2D model_texture;
+uniform bool textured;
+
+void main()
+{
+    gl_FragColor = textured ? gl_Color * texture2D(model_texture, gl_TexCoord[0].st) : gl_Color;
+}
+)";
+
+    GLuint compileShader(const GLenum type, const char *source)
+    {
+        const GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint compiled = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        if (compiled == GL_FALSE)
+        {
+            GLint log_length = 0;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+            std::string log(log_length, '\0');
+            glGetShaderInfoLog(shader, log_length, nullptr, log.data());
+            std::cerr << "Failed to compile the instancing shader: " << log << std::endl;
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+} // namespace
+
+namespace engine
+{
+    bool InstancedRenderer::Init()
+    {
+        if (!GLEW_VERSION_2_0 || !GLEW_ARB_draw_instanced || !GLEW_ARB_instanced_arrays)
+        {
+            std::cerr << "Instanced drawing unsupported, drawing every model on its own" << std::endl;
+            return false;
+        }
+
+        const GLuint vertex_shader = compileShader(GL_VERTEX_SHADER, VERTEX_SHADER);
+        const GLuint fragment_shader = compileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+        if (vertex_shader == 0 || fragment_shader == 0)
+        {
+            glDeleteShader(vertex_shader);
+            glDeleteShader(fragment_shader);
+            return false;
+        }
+
+        const GLuint program = glCreateProgram();
+        glAttachShader(program, vertex_shader);
+        glAttachShader(program, fragment_shader);
+        glBindAttribLocation(program, INSTANCE_TRANSFORM_LOCATION, "instance_transform");
+        glLinkProgram(program);
+        glDeleteShader(vertex_shader);
+        glDeleteShader(fragment_shader);
+
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == GL_FALSE)
+        {
+            GLint log_length = 0;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
+            std::string log(log_length, '\0');
+            glGetProgramInfoLog(program, log_length, nullptr, log.data());
+            std::cerr << "Failed to link the instancing shader: " << log << std::endl;
+            glDeleteProgram(program);
+            return false;
+        }
+
+        m_program = program;
+        m_light_count_location = glGetUniformLocation(program, "light_count");
+        m_lighting_location = glGetUniformLocation(program, "lighting");
+        m_textured_location = glGetUniformLocation(program, "textured");
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "model_texture"), 0);
+        glUseProgram(0);
+        return true;
+    }
+
+    void InstancedRenderer::Upload(const std::vector<DrawPacket> &packets, StreamBuffer &stream)
+    {
+        m_transforms.clear();
+        for (const auto &packet : packets)
+            m_transforms.push_back(packet.transform);
+        if (!m_transforms.empty())
+            m_instances = stream.Upload(m_transforms.data(), m_transforms.size() * sizeof(Mat3x4f));
+    }
+
+    void InstancedRenderer::Begin(const int light_count, const bool lighting) const
+    {
+        glUseProgram(m_program);
+        glUniform1i(m_light_count_location, light_count);
+        glUniform1i(m_lighting_location, lighting);
+        for (GLuint column = 0; column < 4; ++column)
+        {
+            glEnableVertexAttribArray(INSTANCE_TRANSFORM_LOCATION + column);
+            glVertexAttribDivisorARB(INSTANCE_TRANSFORM_LOCATION + column, 1);
+        }
+    }
+
+    void InstancedRenderer::SetTextured(const bool textured) const { glUniform1i(m_textured_location, textured); }
+
+    void InstancedRenderer::Draw(const DrawBatch &batch, const uint32_t index_count) const
+    {
+        // Points the transform at the first packet of the batch, the model buffers stay bound
+        glBindBuffer(GL_ARRAY_BUFFER, m_instances.buffer);
+        for (GLuint column = 0; column < 4; ++column)
+        {
+            const size_t offset = m_instances.offset + batch.first * sizeof(Mat3x4f) + column * 4 * sizeof(float);
+            glVertexAttribPointer(
+                INSTANCE_TRANSFORM_LOCATION + column,
+                4,
+                GL_FLOAT,
+                GL_FALSE,
+                sizeof(Mat3x4f),
+                reinterpret_cast<const void *>(offset)
+            );
+        }
+        glDrawElementsInstancedARB(
+            GL_TRIANGLES,
+            static_cast<GLsizei>(index_count),
+            GL_UNSIGNED_INT,
+            nullptr,
+            static_cast<GLsizei>(batch.count)
+        );
+    }
+
+    void InstancedRenderer::End() const
+    {
+        for (GLuint column = 0; column < 4; ++column)
+        {
+            glVertexAttribDivisorARB(INSTANCE_TRANSFORM_LOCATION + column, 0);
+            glDisableVertexAttribArray(INSTANCE_TRANSFORM_LOCATION + column);
+        }
+        glUseProgram(0);
+    }
+} // namespace engine
@@ -0,0 +1,49 @@
+#ifndef CG_SOLAR_SYSTEM_INSTANCED_RENDERER_H
+#define CG_SOLAR_SYSTEM_INSTANCED_RENDERER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Mat.h"
+#include "RenderQueue.h"
+#include "StreamBuffer.h"
+
+namespace engine
+{
+    // First of the four attribute locations of the instance transform, the columns of a mat4. Drivers alias the
+    // fixed-function attributes to the low locations and the texture coordinates to 8 to 15, and the models only
+    // use the first texture coordinates.
+    constexpr uint32_t INSTANCE_TRANSFORM_LOCATION = 12;
+
+    // Draws every batch of a RenderQueue with one glDrawElementsInstanced. The world transforms of the packets go in
+    // the stream buffer every frame, read per instance by a vertex shader that lights the vertexes like the
+    // fixed-function pipeline does: the enabled lights, the material and the ambient of the light model, before
+    // modulating the texture.
+    class InstancedRenderer
+    {
+        uint32_t m_program = 0;
+        StreamAllocation m_instances; // transforms of the packets of the last Upload
+        int32_t m_light_count_location = -1;
+        int32_t m_lighting_location = -1;
+        int32_t m_textured_location = -1;
+        std::vector<Mat3x4f> m_transforms; // of the last Upload, kept to reuse its capacity
+
+    public:
+        // Compiles the shaders. False, with the reason in std::cerr, when they fail or the GL can't draw instanced.
+        bool Init();
+        bool IsSupported() const { return m_program != 0; }
+
+        // Writes the transforms of packets to stream, in their order, for the draws of this frame
+        void Upload(const std::vector<DrawPacket> &packets, StreamBuffer &stream);
+        // Binds the program, lighting with the first light_count lights when lighting
+        void Begin(int light_count, bool lighting) const;
+        // The texture bound to GL_TEXTURE_2D is modulated only when textured, like texture 0 in the fixed pipeline
+        void SetTextured(bool textured) const;
+        // Draws the bound model buffers for the packets of batch, with index_count indexes each
+        void Draw(const DrawBatch &batch, uint32_t index_count) const;
+        // Back to the fixed-function pipeline
+        void End() const;
+    };
+} // namespace engine
+
+#endif // CG_SOLAR_SYSTEM_INSTANCED_RENDERER_H
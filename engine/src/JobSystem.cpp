@@ -0,0 +1,123 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace engine
+{
+    JobSystem::JobSystem(const size_t thread_count)
+    {
+        const size_t threads = std::max<size_t>(thread_count, 1);
+        for (size_t i = 0; i < threads; ++i)
+            m_queues.push_back(std::make_unique<Queue>());
+        for (size_t i = 1; i < threads; ++i)
+            m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard lock(m_wake_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto &worker : m_workers)
+            worker.join();
+    }
+
+    bool JobSystem::pop(const size_t thread, Job &job)
+    {
+        Queue &queue = *m_queues[thread];
+        std::lock_guard lock(queue.mutex);
+        if (queue.jobs.empty())
+            return false;
+
+        // The newest job, the one whose data is most likely still in cache
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+        m_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool JobSystem::steal(const size_t thread, Job &job)
+    {
+        for (size_t offset = 1; offset < m_queues.size(); ++offset)
+        {
+            Queue &queue = *m_queues[(thread + offset) % m_queues.size()];
+            std::lock_guard lock(queue.mutex);
+            if (queue.jobs.empty())
+                continue;
+
+            // The oldest job, furthest from what the owner works on
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+            m_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void JobSystem::run(const Job &job)
+    {
+        (*job.body)(job.begin, job.end);
+        // Publishes the writes of body to the thread waiting in ParallelFor
+        job.remaining->fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    void JobSystem::workerLoop(const size_t thread)
+    {
+        while (true)
+        {
+            Job job;
+            if (pop(thread, job) || steal(thread, job))
+            {
+                run(job);
+                continue;
+            }
+
+            std::unique_lock lock(m_wake_mutex);
+            m_wake.wait(lock, [this] { return m_stop || m_queued_jobs.load(std::memory_order_relaxed) > 0; });
+            if (m_stop)
+                return;
+        }
+    }
+
+    void JobSystem::ParallelFor(const size_t count, size_t grain, const std::function<void(size_t, size_t)> &body)
+    {
+        grain = std::max<size_t>(grain, 1);
+        const size_t job_count = (count + grain - 1) / grain;
+        if (m_queues.size() == 1 || job_count <= 1)
+        {
+            for (size_t begin = 0; begin < count; begin += grain)
+                body(begin, std::min(begin + grain, count));
+            return;
+        }
+
+        // Every thread starts with a contiguous block of the ranges, stealing only balances what is left
+        std::atomic<size_t> remaining = job_count;
+        m_queued_jobs.fetch_add(job_count, std::memory_order_relaxed);
+        for (size_t thread = 0; thread < m_queues.size(); ++thread)
+        {
+            const size_t first_job = job_count * thread / m_queues.size();
+            const size_t last_job = job_count * (thread + 1) / m_queues.size();
+            Queue &queue = *m_queues[thread];
+            std::lock_guard lock(queue.mutex);
+            // Pushed backwards, so the owner, which pops the newest, goes through its block in order
+            for (size_t i = last_job; i-- > first_job;)
+                queue.jobs.push_back({&body, i * grain, std::min((i + 1) * grain, count), &remaining});
+        }
+        {
+            std::lock_guard lock(m_wake_mutex);
+        }
+        m_wake.notify_all();
+
+        Job job;
+        while (remaining.load(std::memory_order_acquire) > 0)
+        {
+            if (pop(0, job) || steal(0, job))
+                run(job);
+            else
+                std::this_thread::yield();
+        }
+    }
+} // namespace engine
@@ -0,0 +1,64 @@
+#ifndef CG_SOLAR_SYSTEM_JOB_SYSTEM_H
+#define CG_SOLAR_SYSTEM_JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine
+{
+    // Pool of worker threads with one job queue each. A thread runs the newest job of its own queue and, when it
+    // is empty, steals the oldest job of another one, so threads that finish early take over the work of the others.
+    // The thread calling ParallelFor works too, as the thread 0, so a JobSystem of one thread runs everything inline.
+    class JobSystem
+    {
+        struct Job
+        {
+            const std::function<void(size_t, size_t)> *body = nullptr;
+            size_t begin = 0, end = 0;
+            std::atomic<size_t> *remaining = nullptr; // jobs of the ParallelFor not finished yet
+        };
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        std::vector<std::unique_ptr<Queue>> m_queues; // one per thread, the caller of ParallelFor is 0
+        std::vector<std::thread> m_workers;
+        std::atomic<size_t> m_queued_jobs = 0;
+        std::mutex m_wake_mutex;
+        std::condition_variable m_wake;
+        bool m_stop = false;
+        std::atomic<size_t> m_steals = 0; // jobs taken from the queue of another thread since the last ResetSteals
+
+        bool pop(size_t thread, Job &job);
+        bool steal(size_t thread, Job &job);
+        static void run(const Job &job);
+        void workerLoop(size_t thread);
+
+    public:
+        // thread_count threads in total, counting the caller of ParallelFor, at least 1
+        explicit JobSystem(size_t thread_count);
+        ~JobSystem();
+        JobSystem(const JobSystem &) = delete;
+        JobSystem &operator=(const JobSystem &) = delete;
+
+        // Calls body(begin, end) over [0, count) in ranges of at most grain elements, across all the threads, and
+        // returns once every range is done. Not reentrant, body can't call ParallelFor.
+        void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body);
+
+        size_t GetThreadCount() const { return m_queues.size(); }
+        size_t GetSteals() const { return m_steals; }
+        void ResetSteals() { m_steals = 0; }
+    };
+} // namespace engine
+
+#endif // CG_SOLAR_SYSTEM_JOB_SYSTEM_H
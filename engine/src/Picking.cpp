@@ -0,0 +1,444 @@
+#include "Picking.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "Simd.h"
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+#ifdef SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace engine
+{
+    namespace
+    {
+        constexpr size_t BLOCK_FLOATS = PICK_BLOCK_TRIANGLES * 9;
+        // Smaller determinants are triangles seen edge on, or the padding of the last block, which is all zeros
+        constexpr float MIN_DETERMINANT = 1e-12f;
+
+        // Möller–Trumbore against every triangle of the blocks, keeping the nearest hit in front of the origin and
+        // before nearest. Reference implementation, the SSE4 and NEON kernels do the same operations in the same order.
+        void intersectScalar(
+            const float *blocks,
+            const size_t block_count,
+            const Ray &ray,
+            float &nearest,
+            uint32_t &triangle
+        )
+        {
+            const Vec3f &o = ray.origin, &d = ray.direction;
+            for (size_t block = 0; block < block_count; ++block)
+            {
+                const float *values = blocks + block * BLOCK_FLOATS;
+                for (size_t lane = 0; lane < PICK_BLOCK_TRIANGLES; ++lane)
+                {
+                    const auto value = [&](const size_t component)
+                    {
+                        return values[component * PICK_BLOCK_TRIANGLES + lane];
+                    };
+                    const float e1x = value(3), e1y = value(4), e1z = value(5);
+                    const float e2x = value(6), e2y = value(7), e2z = value(8);
+
+                    const float px = d.y * e2z - d.z * e2y;
+                    const float py = d.z * e2x - d.x * e2z;
+                    const float pz = d.x * e2y - d.y * e2x;
+                    const float det = e1x * px + e1y * py + e1z * pz;
+                    const float inverse_det = 1 / det;
+
+                    const float sx = o.x - value(0), sy = o.y - value(1), sz = o.z - value(2);
+                    const float u = (sx * px + sy * py + sz * pz) * inverse_det;
+                    const float qx = sy * e1z - sz * e1y;
+                    const float qy = sz * e1x - sx * e1z;
+                    const float qz = sx * e1y - sy * e1x;
+                    const float v = (d.x * qx + d.y * qy + d.z * qz) * inverse_det;
+                    const float t = (e2x * qx + e2y * qy + e2z * qz) * inverse_det;
+
+                    if (std::abs(det) > MIN_DETERMINANT && u >= 0 && v >= 0 && u + v <= 1 && t > 0 && t < nearest)
+                    {
+                        nearest = t;
+                        triangle = static_cast<uint32_t>(block * PICK_BLOCK_TRIANGLES + lane);
+                    }
+                }
+            }
+        }
+
+        // Lanes of mask that hit, in distances, replace the nearest one when they are closer
+        void keepNearest(
+            const int mask,
+            const float *distances,
+            const size_t first_triangle,
+            float &nearest,
+            uint32_t &triangle
+        )
+        {
+            for (int lane = 0; mask >> lane; ++lane)
+            {
+                if ((mask >> lane & 1) && distances[lane] < nearest)
+                {
+                    nearest = distances[lane];
+                    triangle = static_cast<uint32_t>(first_triangle + lane);
+                }
+            }
+        }
+
+#ifdef SIMD_X86
+        SIMD_TARGET("sse4.1")
+        void intersectSse4(
+            const float *blocks,
+            const size_t block_count,
+            const Ray &ray,
+            float &nearest,
+            uint32_t &triangle
+        )
+        {
+            const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+            const __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y),
+                         dz = _mm_set1_ps(ray.direction.z);
+            const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1);
+            const __m128 sign = _mm_set1_ps(-0.0f), min_det = _mm_set1_ps(MIN_DETERMINANT);
+            alignas(16) float distances[4];
+
+            for (size_t block = 0; block < block_count; ++block)
+            {
+                for (size_t half = 0; half < PICK_BLOCK_TRIANGLES; half += 4)
+                {
+                    const float *values = blocks + block * BLOCK_FLOATS + half;
+                    const __m128 e1x = _mm_loadu_ps(values + 24), e1y = _mm_loadu_ps(values + 32),
+                                 e1z = _mm_loadu_ps(values + 40);
+                    const __m128 e2x = _mm_loadu_ps(values + 48), e2y = _mm_loadu_ps(values + 56),
+                                 e2z = _mm_loadu_ps(values + 64);
+
+                    const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+                    const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+                    const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+                    const __m128 det =
+                        _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+                    const __m128 inverse_det = _mm_div_ps(one, det);
+
+                    const __m128 sx = _mm_sub_ps(ox, _mm_loadu_ps(values));
+                    const __m128 sy = _mm_sub_ps(oy, _mm_loadu_ps(values + 8));
+                    const __m128 sz = _mm_sub_ps(oz, _mm_loadu_ps(values + 16));
+                    const __m128 u = _mm_mul_ps(
+                        _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)),
+                        inverse_det
+                    );
+                    const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+                    const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+                    const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+                    const __m128 v = _mm_mul_ps(
+                        _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)),
+                        inverse_det
+                    );
+                    const __m128 t = _mm_mul_ps(
+                        _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)),
+                        inverse_det
+                    );
+
+                    __m128 hit = _mm_cmpgt_ps(_mm_andnot_ps(sign, det), min_det);
+                    hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+                    hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+                    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+                    hit = _mm_and_ps(hit, _mm_cmpgt_ps(t, zero));
+                    hit = _mm_and_ps(hit, _mm_cmplt_ps(t, _mm_set1_ps(nearest)));
+                    const int mask = _mm_movemask_ps(hit);
+                    if (mask == 0)
+                        continue;
+                    _mm_store_ps(distances, t);
+                    keepNearest(mask, distances, block * PICK_BLOCK_TRIANGLES + half, nearest, triangle);
+                }
+            }
+        }
+
+        // Same as the SSE4 kernel with 8 lanes, a whole block at once, the dot products use FMA
+        SIMD_TARGET("avx2,fma")
+        void intersectAvx2(
+            const float *blocks,
+            const size_t block_count,
+            const Ray &ray,
+            float &nearest,
+            uint32_t &triangle
+        )
+        {
+            const __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y),
+                         oz = _mm256_set1_ps(ray.origin.z);
+            const __m256 dx = _mm256_set1_ps(ray.direction.x), dy = _mm256_set1_ps(ray.direction.y),
+                         dz = _mm256_set1_ps(ray.direction.z);
+            const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1);
+            const __m256 sign = _mm256_set1_ps(-0.0f), min_det = _mm256_set1_ps(MIN_DETERMINANT);
+            alignas(32) float distances[8];
+
+            for (size_t block = 0; block < block_count; ++block)
+            {
+                const float *values = blocks + block * BLOCK_FLOATS;
+                const __m256 e1x = _mm256_loadu_ps(values + 24), e1y = _mm256_loadu_ps(values + 32),
+                             e1z = _mm256_loadu_ps(values + 40);
+                const __m256 e2x = _mm256_loadu_ps(values + 48), e2y = _mm256_loadu_ps(values + 56),
+                             e2z = _mm256_loadu_ps(values + 64);
+
+                const __m256 px = _mm256_fmsub_ps(dy, e2z, _mm256_mul_ps(dz, e2y));
+                const __m256 py = _mm256_fmsub_ps(dz, e2x, _mm256_mul_ps(dx, e2z));
+                const __m256 pz = _mm256_fmsub_ps(dx, e2y, _mm256_mul_ps(dy, e2x));
+                const __m256 det = _mm256_fmadd_ps(e1z, pz, _mm256_fmadd_ps(e1y, py, _mm256_mul_ps(e1x, px)));
+                const __m256 inverse_det = _mm256_div_ps(one, det);
+
+                const __m256 sx = _mm256_sub_ps(ox, _mm256_loadu_ps(values));
+                const __m256 sy = _mm256_sub_ps(oy, _mm256_loadu_ps(values + 8));
+                const __m256 sz = _mm256_sub_ps(oz, _mm256_loadu_ps(values + 16));
+                const __m256 u = _mm256_mul_ps(
+                    _mm256_fmadd_ps(sz, pz, _mm256_fmadd_ps(sy, py, _mm256_mul_ps(sx, px))),
+                    inverse_det
+                );
+                const __m256 qx = _mm256_fmsub_ps(sy, e1z, _mm256_mul_ps(sz, e1y));
+                const __m256 qy = _mm256_fmsub_ps(sz, e1x, _mm256_mul_ps(sx, e1z));
+                const __m256 qz = _mm256_fmsub_ps(sx, e1y, _mm256_mul_ps(sy, e1x));
+                const __m256 v = _mm256_mul_ps(
+                    _mm256_fmadd_ps(dz, qz, _mm256_fmadd_ps(dy, qy, _mm256_mul_ps(dx, qx))),
+                    inverse_det
+                );
+                const __m256 t = _mm256_mul_ps(
+                    _mm256_fmadd_ps(e2z, qz, _mm256_fmadd_ps(e2y, qy, _mm256_mul_ps(e2x, qx))),
+                    inverse_det
+                );
+
+                __m256 hit = _mm256_cmp_ps(_mm256_andnot_ps(sign, det), min_det, _CMP_GT_OQ);
+                hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+                hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+                hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+                hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GT_OQ));
+                hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, _mm256_set1_ps(nearest), _CMP_LT_OQ));
+                const int mask = _mm256_movemask_ps(hit);
+                if (mask == 0)
+                    continue;
+                _mm256_store_ps(distances, t);
+                keepNearest(mask, distances, block * PICK_BLOCK_TRIANGLES, nearest, triangle);
+            }
+        }
+#endif
+
+#ifdef SIMD_NEON
+        void intersectNeon(
+            const float *blocks,
+            const size_t block_count,
+            const Ray &ray,
+            float &nearest,
+            uint32_t &triangle
+        )
+        {
+            const float32x4_t ox = vdupq_n_f32(ray.origin.x), oy = vdupq_n_f32(ray.origin.y),
+                              oz = vdupq_n_f32(ray.origin.z);
+            const float32x4_t dx = vdupq_n_f32(ray.direction.x), dy = vdupq_n_f32(ray.direction.y),
+                              dz = vdupq_n_f32(ray.direction.z);
+            const float32x4_t zero = vdupq_n_f32(0), one = vdupq_n_f32(1), min_det = vdupq_n_f32(MIN_DETERMINANT);
+            float distances[4];
+            uint32_t lanes[4];
+
+            for (size_t block = 0; block < block_count; ++block)
+            {
+                for (size_t half = 0; half < PICK_BLOCK_TRIANGLES; half += 4)
+                {
+                    const float *values = blocks + block * BLOCK_FLOATS + half;
+                    const float32x4_t e1x = vld1q_f32(values + 24), e1y = vld1q_f32(values + 32),
+                                      e1z = vld1q_f32(values + 40);
+                    const float32x4_t e2x = vld1q_f32(values + 48), e2y = vld1q_f32(values + 56),
+                                      e2z = vld1q_f32(values + 64);
+
+                    const float32x4_t px = vsubq_f32(vmulq_f32(dy, e2z), vmulq_f32(dz, e2y));
+                    const float32x4_t py = vsubq_f32(vmulq_f32(dz, e2x), vmulq_f32(dx, e2z));
+                    const float32x4_t pz = vsubq_f32(vmulq_f32(dx, e2y), vmulq_f32(dy, e2x));
+                    const float32x4_t det =
+                        vaddq_f32(vaddq_f32(vmulq_f32(e1x, px), vmulq_f32(e1y, py)), vmulq_f32(e1z, pz));
+                    const float32x4_t inverse_det = vdivq_f32(one, det);
+
+                    const float32x4_t sx = vsubq_f32(ox, vld1q_f32(values));
+                    const float32x4_t sy = vsubq_f32(oy, vld1q_f32(values + 8));
+                    const float32x4_t sz = vsubq_f32(oz, vld1q_f32(values + 16));
+                    const float32x4_t u = vmulq_f32(
+                        vaddq_f32(vaddq_f32(vmulq_f32(sx, px), vmulq_f32(sy, py)), vmulq_f32(sz, pz)),
+                        inverse_det
+                    );
+                    const float32x4_t qx = vsubq_f32(vmulq_f32(sy, e1z), vmulq_f32(sz, e1y));
+                    const float32x4_t qy = vsubq_f32(vmulq_f32(sz, e1x), vmulq_f32(sx, e1z));
+                    const float32x4_t qz = vsubq_f32(vmulq_f32(sx, e1y), vmulq_f32(sy, e1x));
+                    const float32x4_t v = vmulq_f32(
+                        vaddq_f32(vaddq_f32(vmulq_f32(dx, qx), vmulq_f32(dy, qy)), vmulq_f32(dz, qz)),
+                        inverse_det
+                    );
+                    const float32x4_t t = vmulq_f32(
+                        vaddq_f32(vaddq_f32(vmulq_f32(e2x, qx), vmulq_f32(e2y, qy)), vmulq_f32(e2z, qz)),
+                        inverse_det
+                    );
+
+                    uint32x4_t hit = vcgtq_f32(vabsq_f32(det), min_det);
+                    hit = vandq_u32(hit, vcgeq_f32(u, zero));
+                    hit = vandq_u32(hit, vcgeq_f32(v, zero));
+                    hit = vandq_u32(hit, vcleq_f32(vaddq_f32(u, v), one));
+                    hit = vandq_u32(hit, vcgtq_f32(t, zero));
+                    hit = vandq_u32(hit, vcltq_f32(t, vdupq_n_f32(nearest)));
+                    if (vmaxvq_u32(hit) == 0)
+                        continue;
+
+                    vst1q_f32(distances, t);
+                    vst1q_u32(lanes, hit);
+                    int mask = 0;
+                    for (int lane = 0; lane < 4; ++lane)
+                        mask |= (lanes[lane] != 0) << lane;
+                    keepNearest(mask, distances, block * PICK_BLOCK_TRIANGLES + half, nearest, triangle);
+                }
+            }
+        }
+#endif
+
+        using IntersectKernel = void (*)(const float *, size_t, const Ray &, float &, uint32_t &);
+
+        // Indexed by simd::InstructionSet, instruction sets not available in this architecture fall back to scalar
+        constexpr IntersectKernel INTERSECT_KERNELS[static_cast<int>(simd::InstructionSet::COUNT)] = {
+            intersectScalar,
+#ifdef SIMD_X86
+            intersectSse4,
+            intersectAvx2,
+#else
+            intersectScalar,
+            intersectScalar,
+#endif
+#ifdef SIMD_NEON
+            intersectNeon,
+#else
+            intersectScalar,
+#endif
+        };
+    } // namespace
+
+    Ray CreateRayFromCamera(
+        const Vec3f &cameraPosition,
+        const Vec3f &cameraLookingAt,
+        const Vec3f &cameraUp,
+        const float fov,
+        const float aspectRatio,
+        const Vec2f &windowPosition,
+        const Vec2f &windowSize
+    )
+    {
+        const Vec3f front = (cameraLookingAt - cameraPosition).Normalize();
+        const Vec3f right = front.Cross(cameraUp).Normalize();
+        const Vec3f up = right.Cross(front).Normalize();
+
+        // From -1 to 1 across the window, with y going up
+        const float x = windowPosition.x / windowSize.x * 2 - 1;
+        const float y = 1 - windowPosition.y / windowSize.y * 2;
+        const float half_height = tanf(degrees_to_radians(fov) * .5f);
+        const Vec3f direction = front + right * (x * half_height * aspectRatio) + up * (y * half_height);
+        return {cameraPosition, direction.Normalize()};
+    }
+
+    const std::vector<float> &Picker::getTriangleBlocks(const size_t model_index, model::Model &model)
+    {
+        if (model_index >= m_prepared.size())
+        {
+            m_prepared.resize(model_index + 1, 0);
+            m_triangle_blocks.resize(model_index + 1);
+        }
+        auto &blocks = m_triangle_blocks[model_index];
+        if (m_prepared[model_index])
+            return blocks;
+        m_prepared[model_index] = 1;
+
+        const auto &vertex = model.GetVertex();
+        const auto &indexes = model.GetIndexes();
+        const size_t triangles = indexes.size() / 3;
+        blocks.assign((triangles + PICK_BLOCK_TRIANGLES - 1) / PICK_BLOCK_TRIANGLES * BLOCK_FLOATS, 0);
+        for (size_t triangle = 0; triangle < triangles; ++triangle)
+        {
+            const Vec3f &v0 = vertex[indexes[triangle * 3]];
+            const Vec3f edge1 = vertex[indexes[triangle * 3 + 1]] - v0;
+            const Vec3f edge2 = vertex[indexes[triangle * 3 + 2]] - v0;
+            const Vec3f components[3] = {v0, edge1, edge2};
+
+            float *values = blocks.data() + triangle / PICK_BLOCK_TRIANGLES * BLOCK_FLOATS;
+            const size_t lane = triangle % PICK_BLOCK_TRIANGLES;
+            for (int i = 0; i < 3; ++i)
+            {
+                values[(i * 3) * PICK_BLOCK_TRIANGLES + lane] = components[i].x;
+                values[(i * 3 + 1) * PICK_BLOCK_TRIANGLES + lane] = components[i].y;
+                values[(i * 3 + 2) * PICK_BLOCK_TRIANGLES + lane] = components[i].z;
+            }
+        }
+        return blocks;
+    }
+
+    void Picker::intersectInstance(
+        const Scene &scene,
+        std::vector<model::Model> &models,
+        const size_t instance,
+        const Ray &ray,
+        float &max_distance,
+        std::optional<PickHit> &hit
+    )
+    {
+        m_tested_instances++;
+        const size_t model_index = scene.GetInstanceModel(instance).model_index;
+        const auto &blocks = getTriangleBlocks(model_index, models[model_index]);
+        m_tested_triangles += models[model_index].GetIndexes().size() / 3;
+
+        // An affine transform keeps the distances along the ray, so the ones in the space of the model are the same
+        const Mat3x4f inverse = scene.GetInstanceTransform(instance).Inverse();
+        const Ray model_ray = {inverse.TransformPoint(ray.origin), inverse.TransformDirection(ray.direction)};
+        uint32_t triangle = UINT32_MAX;
+        INTERSECT_KERNELS[static_cast<int>(simd::GetActive())](
+            blocks.data(),
+            blocks.size() / BLOCK_FLOATS,
+            model_ray,
+            max_distance,
+            triangle
+        );
+        if (triangle == UINT32_MAX)
+            return;
+
+        const uint32_t node = scene.GetInstanceNode(instance);
+        hit = PickHit{instance, node, {}, triangle, max_distance, ray.origin + ray.direction * max_distance};
+    }
+
+    std::optional<PickHit> Picker::Pick(const Scene &scene, std::vector<model::Model> &models, const Ray &ray)
+    {
+        m_tested_nodes = 0;
+        m_tested_instances = 0;
+        m_tested_triangles = 0;
+        std::optional<PickHit> hit;
+        float max_distance = INFINITY;
+
+        // Every instance the ray goes through, nearest first, until the next one starts behind the nearest hit
+        const Vec3f inverse_direction = {1 / ray.direction.x, 1 / ray.direction.y, 1 / ray.direction.z};
+        std::vector<std::pair<float, size_t>> candidates;
+        for (size_t instance = 0; instance < scene.GetInstanceCount(); ++instance)
+        {
+            float distance;
+            if (scene.GetInstanceBounds(instance).IntersectsRay(ray.origin, inverse_direction, INFINITY, distance))
+                candidates.emplace_back(distance, instance);
+        }
+        m_tested_nodes = scene.GetInstanceCount();
+        std::ranges::sort(candidates);
+        for (const auto &[distance, instance] : candidates)
+        {
+            if (distance > max_distance)
+                break;
+            intersectInstance(scene, models, instance, ray, max_distance, hit);
+        }
+
+        if (hit.has_value())
+            hit->path = scene.GetNodePath(hit->node);
+        return hit;
+    }
+
+    void Picker::Clear()
+    {
+        m_triangle_blocks.clear();
+        m_prepared.clear();
+        m_tested_nodes = 0;
+        m_tested_instances = 0;
+        m_tested_triangles = 0;
+    }
+} // namespace engine
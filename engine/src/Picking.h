@@ -0,0 +1,83 @@
+#ifndef CG_SOLAR_SYSTEM_PICKING_H
+#define CG_SOLAR_SYSTEM_PICKING_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Model.h"
+#include "Scene.h"
+#include "Vec.h"
+
+namespace engine
+{
+    // Triangles per block of the narrow phase, 8 lanes of AVX2 or two rounds of 4 with SSE4 and NEON
+    constexpr size_t PICK_BLOCK_TRIANGLES = 8;
+
+    struct Ray
+    {
+        Vec3f origin;
+        Vec3f direction; // normalized, so distances along it are in world units
+    };
+
+    // Ray from the camera through a point of the window, in pixels from its top left corner like the GLFW cursor,
+    // for the same perspective as CreateFrustumFromCamera
+    Ray CreateRayFromCamera(
+        const Vec3f &cameraPosition,
+        const Vec3f &cameraLookingAt,
+        const Vec3f &cameraUp,
+        float fov,
+        float aspectRatio,
+        const Vec2f &windowPosition,
+        const Vec2f &windowSize
+    );
+
+    struct PickHit
+    {
+        size_t instance;
+        uint32_t node; // group of the instance
+        std::vector<uint32_t> path; // nodes from the root down to node
+        uint32_t triangle; // of the model, its indexes start at triangle * 3
+        float distance; // along the ray
+        Vec3f position;
+    };
+
+    // Nearest model instance under a ray. The broad phase goes through every instance bounds, nearest first. Then the
+    // triangles of the model of every instance the ray reaches before the nearest hit are tested in the space of the
+    // model, in blocks of PICK_BLOCK_TRIANGLES with the SIMD kernels of simd::GetActive().
+    class Picker
+    {
+        // Per model, its triangles as blocks of PICK_BLOCK_TRIANGLES: the v0 x y z, edge1 x y z and edge2 x y z
+        // of every triangle of the block, one after the other. Filled the first time the model is reached.
+        std::vector<std::vector<float>> m_triangle_blocks;
+        std::vector<uint8_t> m_prepared;
+
+        size_t m_tested_nodes = 0;
+        size_t m_tested_instances = 0;
+        size_t m_tested_triangles = 0;
+
+        const std::vector<float> &getTriangleBlocks(size_t model_index, model::Model &model);
+        // Nearest hit of ray with the triangles of instance before max_distance, updating it and hit
+        void intersectInstance(
+            const Scene &scene,
+            std::vector<model::Model> &models,
+            size_t instance,
+            const Ray &ray,
+            float &max_distance,
+            std::optional<PickHit> &hit
+        );
+
+    public:
+        // Forgets the triangles of the models, which have to be the same ones in every Pick until then
+        void Clear();
+
+        std::optional<PickHit> Pick(const Scene &scene, std::vector<model::Model> &models, const Ray &ray);
+
+        // Of the last Pick
+        size_t GetTestedNodes() const { return m_tested_nodes; }
+        size_t GetTestedInstances() const { return m_tested_instances; }
+        size_t GetTestedTriangles() const { return m_tested_triangles; }
+    };
+} // namespace engine
+
+#endif // CG_SOLAR_SYSTEM_PICKING_H
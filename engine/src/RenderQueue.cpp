@@ -0,0 +1,91 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr size_t MATERIALS_SEARCHED = 32;
+} // namespace
+
+namespace engine
+{
+    uint64_t MakeDrawSortKey(const DrawPacket &packet)
+    {
+        constexpr uint64_t MODEL_MASK = (uint64_t{1} << DRAW_SORT_KEY_MODEL_BITS) - 1;
+        constexpr uint64_t TEXTURE_MASK = (uint64_t{1} << DRAW_SORT_KEY_TEXTURE_BITS) - 1;
+        constexpr uint64_t MATERIAL_MASK = (uint64_t{1} << DRAW_SORT_KEY_MATERIAL_BITS) - 1;
+
+        const uint64_t texture = packet.texture_index ? *packet.texture_index + 1 : 0;
+        return (packet.model_index & MODEL_MASK) << (DRAW_SORT_KEY_TEXTURE_BITS + DRAW_SORT_KEY_MATERIAL_BITS) |
+            (texture & TEXTURE_MASK) << DRAW_SORT_KEY_MATERIAL_BITS | (packet.material_index & MATERIAL_MASK);
+    }
+
+    uint32_t RenderQueue::materialIndex(const world::ModelMaterial &material)
+    {
+        // Scenes have a handful of materials, and neighbouring groups usually share theirs, so only the last ones
+        // added are searched. A material seen again after more than that is added twice, and only sorts less well.
+        const size_t searched = std::min(m_materials.size(), MATERIALS_SEARCHED);
+        for (size_t i = m_materials.size(); i-- > m_materials.size() - searched;)
+        {
+            if (m_materials[i] == material)
+                return static_cast<uint32_t>(i);
+        }
+        m_materials.push_back(material);
+        return static_cast<uint32_t>(m_materials.size() - 1);
+    }
+
+    void RenderQueue::Collect(const Scene &scene, const bool only_visible)
+    {
+        Clear();
+        for (size_t instance = 0; instance < scene.GetInstanceCount(); ++instance)
+        {
+            if (only_visible && !scene.IsInstanceVisible(instance))
+                continue;
+
+            const world::GroupModel &model = scene.GetInstanceModel(instance);
+            DrawPacket &packet = m_packets.emplace_back();
+            packet.transform = scene.GetInstanceTransform(instance);
+            packet.model_index = model.model_index;
+            packet.texture_index = model.texture_index;
+            packet.material_index = materialIndex(model.material);
+            packet.index_count = scene.GetInstanceIndexCount(instance);
+            packet.sort_key = MakeDrawSortKey(packet);
+            m_index_count += packet.index_count;
+        }
+    }
+
+    void RenderQueue::Clear()
+    {
+        // Keeps the capacity, the queue is collected again every frame
+        m_packets.clear();
+        m_materials.clear();
+        m_batches.clear();
+        m_index_count = 0;
+    }
+
+    void RenderQueue::Sort()
+    {
+        std::ranges::sort(m_packets, {}, &DrawPacket::sort_key);
+    }
+
+    void RenderQueue::Batch()
+    {
+        m_batches.clear();
+        for (size_t i = 0; i < m_packets.size(); ++i)
+        {
+            const DrawPacket &packet = m_packets[i];
+            if (!m_batches.empty())
+            {
+                const DrawPacket &previous = m_packets[i - 1];
+                // The model decides the index count, so packets of the same model draw the same indexes
+                if (packet.model_index == previous.model_index && packet.texture_index == previous.texture_index &&
+                    packet.material_index == previous.material_index)
+                {
+                    m_batches.back().count++;
+                    continue;
+                }
+            }
+            m_batches.push_back({i, 1});
+        }
+    }
+} // namespace engine
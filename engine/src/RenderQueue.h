@@ -0,0 +1,85 @@
+#ifndef CG_SOLAR_SYSTEM_RENDER_QUEUE_H
+#define CG_SOLAR_SYSTEM_RENDER_QUEUE_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Mat.h"
+#include "Scene.h"
+#include "World.h"
+
+namespace engine
+{
+    // Bits of each part of a sort key, from the most significant. Models past 2^20, textures past 2^20 - 1 or
+    // materials past 2^24 share keys and only sort less well.
+    constexpr int DRAW_SORT_KEY_MODEL_BITS = 20;
+    constexpr int DRAW_SORT_KEY_TEXTURE_BITS = 20;
+    constexpr int DRAW_SORT_KEY_MATERIAL_BITS = 24;
+
+    // One draw of a model, with everything the submission needs so it doesn't go back to the scene
+    struct DrawPacket
+    {
+        uint64_t sort_key = 0; // see MakeDrawSortKey
+        Mat3x4f transform = Mat3x4fIdentity; // world transform of the model
+        size_t model_index = 0; // Index of the model in World::m_model_names
+        std::optional<size_t> texture_index = {}; // Index of the texture in World::m_texture_names
+        uint32_t material_index = 0; // Index of the material in RenderQueue::GetMaterials
+        uint32_t index_count = 0;
+    };
+
+    // Packets from first to first + count, one after the other in the queue, with the same model, texture and material,
+    // so one instanced draw can submit all of them
+    struct DrawBatch
+    {
+        size_t first = 0;
+        size_t count = 0;
+    };
+
+    // The model buffers, the texture, plus one so no texture is 0, and the material, packed from the most expensive
+    // state to change to the cheapest. Packets sorted by it bind each model and texture about once.
+    uint64_t MakeDrawSortKey(const DrawPacket &packet);
+
+    // Draws of a frame, collected from the scene in a pass of their own so the GL submission only walks a flat list
+    class RenderQueue
+    {
+        std::vector<DrawPacket> m_packets;
+        std::vector<world::ModelMaterial> m_materials; // every different material of the packets
+        std::vector<DrawBatch> m_batches;
+        size_t m_index_count = 0;
+
+        uint32_t materialIndex(const world::ModelMaterial &material);
+
+    public:
+        // Replaces the packets with one per instance of scene, only the ones visible in its last Cull if only_visible
+        void Collect(const Scene &scene, bool only_visible);
+        void Clear();
+        // Orders the packets by their sort key
+        void Sort();
+        // Groups the packets into batches, as few as there are different states once sorted
+        void Batch();
+
+        const std::vector<DrawPacket> &GetPackets() const { return m_packets; }
+        const std::vector<world::ModelMaterial> &GetMaterials() const { return m_materials; }
+        // Of the last Batch
+        const std::vector<DrawBatch> &GetBatches() const { return m_batches; }
+        size_t GetIndexCount() const { return m_index_count; }
+    };
+
+    // GL state changes of one submission of a RenderQueue, and the ones skipped because the previous draw had already
+    // set the same state
+    struct DrawStateStats
+    {
+        size_t draws = 0; // GL draw calls, one per batch when instanced
+        size_t batches = 0;
+        size_t instances = 0; // drawn by the instanced draws
+        size_t model_binds = 0; // each binds the four buffers of a model
+        size_t texture_binds = 0;
+        size_t material_changes = 0; // each sets the five material parameters
+        size_t model_binds_skipped = 0;
+        size_t texture_binds_skipped = 0;
+        size_t material_changes_skipped = 0;
+    };
+} // namespace engine
+
+#endif // CG_SOLAR_SYSTEM_RENDER_QUEUE_H
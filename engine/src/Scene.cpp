@@ -0,0 +1,270 @@
+#include "Scene.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace engine
+{
+    void Scene::addGroup(world::WorldGroup &group, const uint32_t parent, std::vector<model::Model> &models)
+    {
+        const auto node = static_cast<uint32_t>(m_parents.size());
+        m_groups.push_back(&group);
+        m_transforms.push_back(&group.transformations);
+        m_parents.push_back(parent);
+        m_subtree_ends.push_back(node + 1);
+        m_instance_offsets.push_back(static_cast<uint32_t>(m_instance_nodes.size()));
+
+        for (const auto &group_model : group.models)
+        {
+            auto &model = models[group_model.model_index];
+            m_instance_nodes.push_back(node);
+            m_instance_models.push_back(&group_model);
+            m_instance_index_counts.push_back(static_cast<uint32_t>(model.GetIndexes().size()));
+            m_instance_model_bounds.push_back(model.GetAABB());
+        }
+
+        for (auto &child : group.children)
+        {
+            addGroup(child, node, models);
+        }
+        m_subtree_ends[node] = static_cast<uint32_t>(m_parents.size());
+    }
+
+    void Scene::Build(world::WorldGroup &root, std::vector<model::Model> &models)
+    {
+        Clear();
+        addGroup(root, SCENE_NO_PARENT, models);
+        m_instance_offsets.push_back(static_cast<uint32_t>(m_instance_nodes.size()));
+        buildLevels();
+
+        const size_t nodes = m_parents.size();
+        m_local_transforms.resize(nodes, Mat3x4fIdentity);
+        m_world_transforms.resize(nodes, Mat3x4fIdentity);
+        m_transform_versions.resize(nodes, 0);
+        m_changed.resize(nodes, 1);
+        m_subtree_time_dependent.resize(nodes, 1);
+        m_subtree_changed.resize(nodes, 1);
+        m_subtree_bounds.resize(nodes);
+        m_instance_bounds.resize(m_instance_nodes.size());
+        m_instance_visible.resize(m_instance_nodes.size(), 1);
+        m_full_update = true;
+    }
+
+    void Scene::Clear()
+    {
+        m_groups.clear();
+        m_transforms.clear();
+        m_parents.clear();
+        m_subtree_ends.clear();
+        m_local_transforms.clear();
+        m_world_transforms.clear();
+        m_transform_versions.clear();
+        m_changed.clear();
+        m_subtree_time_dependent.clear();
+        m_subtree_changed.clear();
+        m_subtree_bounds.clear();
+        m_instance_offsets.clear();
+        m_level_nodes.clear();
+        m_level_offsets.clear();
+
+        m_instance_nodes.clear();
+        m_instance_models.clear();
+        m_instance_index_counts.clear();
+        m_instance_model_bounds.clear();
+        m_instance_bounds.clear();
+        m_instance_visible.clear();
+        m_evaluated_transforms = 0;
+        m_visible_instances = 0;
+        m_tested_nodes = 0;
+        m_skipped_nodes = 0;
+    }
+
+    void Scene::buildLevels()
+    {
+        // A parent comes before its children, so its depth is known when they are reached
+        std::vector<uint32_t> depths(m_parents.size(), 0);
+        uint32_t levels = m_parents.empty() ? 0 : 1;
+        for (size_t node = 1; node < m_parents.size(); ++node)
+        {
+            depths[node] = depths[m_parents[node]] + 1;
+            levels = std::max(levels, depths[node] + 1);
+        }
+
+        // Counting sort by depth, keeping the depth-first order inside a level
+        m_level_offsets.assign(levels + 1, 0);
+        for (const uint32_t depth : depths)
+            m_level_offsets[depth + 1]++;
+        for (size_t level = 0; level < levels; ++level)
+            m_level_offsets[level + 1] += m_level_offsets[level];
+
+        m_level_nodes.resize(m_parents.size());
+        std::vector<uint32_t> next(m_level_offsets.begin(), m_level_offsets.end() - 1);
+        for (uint32_t node = 0; node < m_parents.size(); ++node)
+            m_level_nodes[next[depths[node]]++] = node;
+    }
+
+    std::vector<uint32_t> Scene::GetNodePath(const size_t node) const
+    {
+        std::vector<uint32_t> path;
+        for (auto current = static_cast<uint32_t>(node); current != SCENE_NO_PARENT; current = m_parents[current])
+            path.push_back(current);
+        std::ranges::reverse(path);
+        return path;
+    }
+
+    void Scene::updateInstanceBounds(const size_t begin, const size_t end)
+    {
+        for (size_t instance = begin; instance < end; ++instance)
+        {
+            const uint32_t node = m_instance_nodes[instance];
+            if (m_changed[node])
+                m_instance_bounds[instance] = m_instance_model_bounds[instance].Transform(m_world_transforms[node]);
+        }
+    }
+
+    void Scene::refitSubtrees()
+    {
+        const auto extend = [](AABB &bounds, const AABB &other)
+        {
+            if (std::isnan(other.min.x))
+                return;
+            bounds.Extend(other.min);
+            bounds.Extend(other.max);
+        };
+
+        // Children come after their parent, so walking backwards finishes a subtree before its parent reads it
+        for (size_t node = m_parents.size(); node-- > 0;)
+        {
+            if (m_subtree_changed[node])
+            {
+                AABB bounds;
+                for (size_t instance = m_instance_offsets[node]; instance < m_instance_offsets[node + 1]; ++instance)
+                    extend(bounds, m_instance_bounds[instance]);
+                for (size_t child = node + 1; child < m_subtree_ends[node]; child = m_subtree_ends[child])
+                    extend(bounds, m_subtree_bounds[child]);
+                m_subtree_bounds[node] = bounds;
+            }
+
+            const uint32_t parent = m_parents[node];
+            if (parent == SCENE_NO_PARENT)
+                continue;
+            if (m_subtree_changed[node])
+                m_subtree_changed[parent] = 1;
+            if (m_subtree_time_dependent[node])
+                m_subtree_time_dependent[parent] = 1;
+        }
+    }
+
+    void Scene::Cull(const Frustum &frustum, JobSystem &jobs)
+    {
+        std::atomic<size_t> visible = 0;
+        jobs.ParallelFor(
+            m_instance_nodes.size(),
+            SCENE_JOB_GRAIN,
+            [&](const size_t begin, const size_t end)
+            {
+                size_t range_visible = 0;
+                for (size_t instance = begin; instance < end; ++instance)
+                {
+                    m_instance_visible[instance] = frustum.HasInside(m_instance_bounds[instance]);
+                    range_visible += m_instance_visible[instance];
+                }
+                visible.fetch_add(range_visible, std::memory_order_relaxed);
+            }
+        );
+        m_visible_instances = visible.load(std::memory_order_relaxed);
+    }
+
+    void Scene::CullGroups(const Frustum &frustum, JobSystem &jobs)
+    {
+        std::atomic<size_t> tested = 0, skipped = 0, visible = 0;
+        jobs.ParallelFor(
+            m_parents.size(),
+            SCENE_JOB_GRAIN,
+            [&](const size_t begin, const size_t end)
+            {
+                size_t range_tested = 0, range_skipped = 0, range_visible = 0;
+                cullNodes(frustum, begin, end, range_tested, range_skipped, range_visible);
+                tested.fetch_add(range_tested, std::memory_order_relaxed);
+                skipped.fetch_add(range_skipped, std::memory_order_relaxed);
+                visible.fetch_add(range_visible, std::memory_order_relaxed);
+            }
+        );
+        m_tested_nodes = tested.load(std::memory_order_relaxed);
+        m_skipped_nodes = skipped.load(std::memory_order_relaxed);
+        m_visible_instances = visible.load(std::memory_order_relaxed);
+    }
+
+    void Scene::cullNodes(
+        const Frustum &frustum,
+        const size_t begin,
+        const size_t end,
+        size_t &tested,
+        size_t &skipped,
+        size_t &visible
+    )
+    {
+        // A subtree without instances has empty (NaN) bounds, culled like one outside
+        const auto test = [&](const size_t node)
+        {
+            const AABB &bounds = m_subtree_bounds[node];
+            return std::isnan(bounds.min.x) ? FrustumTest::OUTSIDE : frustum.Test(bounds);
+        };
+
+        // The range may start inside of a subtree that is culled or accepted as a whole, its ancestors before the
+        // range are tested again to find it. The ones across the border of frustum also are for the nodes after it.
+        size_t node = begin;
+        std::vector<uint32_t> ancestors;
+        for (uint32_t parent = m_parents[begin]; parent != SCENE_NO_PARENT; parent = m_parents[parent])
+            ancestors.push_back(parent);
+        for (size_t i = ancestors.size(); i-- > 0;)
+        {
+            const FrustumTest result = test(ancestors[i]);
+            if (result != FrustumTest::INTERSECTING)
+            {
+                node = std::min<size_t>(m_subtree_ends[ancestors[i]], end);
+                skipped += node - begin;
+                visible += setNodesVisible(begin, node, result == FrustumTest::INSIDE);
+                break;
+            }
+        }
+
+        while (node < end)
+        {
+            const uint32_t first = m_instance_offsets[node], last = m_instance_offsets[node + 1];
+            tested++;
+            // Culling or accepting a leaf as a whole saves nothing, the only instance of one has its bounds
+            if (m_subtree_ends[node] == node + 1 && last - first == 1)
+            {
+                m_instance_visible[first] = frustum.HasInside(m_instance_bounds[first]);
+                visible += m_instance_visible[first];
+                node++;
+                continue;
+            }
+
+            const FrustumTest result = test(node);
+            if (result != FrustumTest::INTERSECTING)
+            {
+                const size_t subtree_end = std::min<size_t>(m_subtree_ends[node], end);
+                skipped += subtree_end - node - 1;
+                visible += setNodesVisible(node, subtree_end, result == FrustumTest::INSIDE);
+                node = subtree_end;
+                continue;
+            }
+            for (uint32_t instance = first; instance < last; ++instance)
+            {
+                m_instance_visible[instance] = frustum.HasInside(m_instance_bounds[instance]);
+                visible += m_instance_visible[instance];
+            }
+            node++;
+        }
+    }
+
+    size_t Scene::setNodesVisible(const size_t begin, const size_t end, const bool visible)
+    {
+        const auto first = m_instance_visible.begin() + m_instance_offsets[begin];
+        const auto last = m_instance_visible.begin() + m_instance_offsets[end];
+        std::fill(first, last, visible);
+        return visible ? static_cast<size_t>(last - first) : 0;
+    }
+} // namespace engine
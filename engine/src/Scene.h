@@ -0,0 +1,179 @@
+#ifndef CG_SOLAR_SYSTEM_SCENE_H
+#define CG_SOLAR_SYSTEM_SCENE_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "Frustum.h"
+#include "JobSystem.h"
+#include "Mat.h"
+#include "Model.h"
+#include "World.h"
+
+namespace engine
+{
+    constexpr uint32_t SCENE_NO_PARENT = UINT32_MAX;
+    // Nodes or instances per job of the JobSystem, enough to pay for taking a job from a queue
+    constexpr size_t SCENE_JOB_GRAIN = 256;
+
+    // Runtime form of the WorldGroup tree, which stays the model that is edited and serialized. The groups are
+    // flattened in depth-first order into parallel arrays, a parent before its children and every subtree contiguous,
+    // so each frame walks them linearly instead of recursing into the tree. Build has to be called again when groups
+    // or models are added or removed, edits of the transforms are picked up by Update.
+    // Update splits its work across a JobSystem, the groups of each depth in parallel after their parents, and the
+    // culling splits the groups or instances in ranges.
+    class Scene
+    {
+        // Per node, a node is a group
+        std::vector<world::WorldGroup *> m_groups;
+        std::vector<world::GroupTransform *> m_transforms; // the local transform program of the group
+        std::vector<uint32_t> m_parents; // SCENE_NO_PARENT for the root
+        std::vector<uint32_t> m_subtree_ends; // one past the last node of the subtree
+        std::vector<Mat3x4f> m_local_transforms;
+        std::vector<Mat3x4f> m_world_transforms;
+        std::vector<size_t> m_transform_versions; // GroupTransform::GetVersion of m_local_transforms
+        std::vector<uint8_t> m_changed; // if the world transform changed in the last Update
+        std::vector<uint8_t> m_subtree_time_dependent; // if the group or any group below it is time dependent
+        std::vector<uint8_t> m_subtree_changed; // if the world transform of any group of the subtree changed
+        // World bounds of every instance of the subtree, refitted when the subtree changed. Empty (NaN) if it has none.
+        std::vector<AABB> m_subtree_bounds;
+        // Instances of node n are from m_instance_offsets[n] to m_instance_offsets[n + 1], and the ones of its
+        // subtree up to m_instance_offsets[m_subtree_ends[n]]
+        std::vector<uint32_t> m_instance_offsets;
+        // Nodes sorted by depth, the ones of depth d from m_level_offsets[d] to m_level_offsets[d + 1]
+        std::vector<uint32_t> m_level_nodes;
+        std::vector<uint32_t> m_level_offsets;
+
+        // Per instance, an instance is a model of a group
+        std::vector<uint32_t> m_instance_nodes;
+        std::vector<const world::GroupModel *> m_instance_models;
+        std::vector<uint32_t> m_instance_index_counts;
+        std::vector<AABB> m_instance_model_bounds; // of the model in its own space
+        std::vector<AABB> m_instance_bounds; // in world space
+        std::vector<uint8_t> m_instance_visible; // if the bounds were inside the frustum of the last Cull
+
+        bool m_full_update = true; // the next Update evaluates every group, after a Build
+        size_t m_evaluated_transforms = 0;
+        size_t m_visible_instances = 0;
+        size_t m_tested_nodes = 0; // by the last CullGroups
+        size_t m_skipped_nodes = 0; // by the last CullGroups, culled or accepted with a parent without testing them
+
+        void addGroup(world::WorldGroup &group, uint32_t parent, std::vector<model::Model> &models);
+        void buildLevels();
+        void updateInstanceBounds(size_t begin, size_t end);
+        void refitSubtrees();
+        // Culls the nodes from begin to end, sets the visibility of their instances and counts them in the arguments
+        void cullNodes(
+            const Frustum &frustum,
+            size_t begin,
+            size_t end,
+            size_t &tested,
+            size_t &skipped,
+            size_t &visible
+        );
+        // Sets the visibility of the instances of the nodes from begin to end, returns how many
+        size_t setNodesVisible(size_t begin, size_t end, bool visible);
+
+        // Returns if the local transform of node was evaluated
+        template <typename EvaluateTransform>
+        bool updateNode(const uint32_t node, EvaluateTransform &evaluate)
+        {
+            world::GroupTransform &transforms = *m_transforms[node];
+            const uint32_t parent = m_parents[node];
+            const bool time_dependent = transforms.IsTimeDependent();
+            const bool changed = m_full_update || time_dependent || (parent != SCENE_NO_PARENT && m_changed[parent]) ||
+                m_transform_versions[node] != transforms.GetVersion();
+            m_changed[node] = changed;
+            m_subtree_changed[node] = changed;
+            m_subtree_time_dependent[node] = time_dependent;
+            if (!changed)
+                return false;
+
+            m_local_transforms[node] = evaluate(transforms);
+            m_world_transforms[node] = parent == SCENE_NO_PARENT
+                ? m_local_transforms[node]
+                : m_world_transforms[parent] * m_local_transforms[node];
+            m_transform_versions[node] = transforms.GetVersion();
+            return true;
+        }
+
+    public:
+        void Build(world::WorldGroup &root, std::vector<model::Model> &models);
+        void Clear();
+
+        // Evaluates the local transforms, with evaluate(GroupTransform &) -> Mat3x4f, of the groups that are time
+        // dependent, were edited since the last Update or whose parent changed, and composes their world transforms
+        // and the world bounds of their models. The rest keep the ones of the last Update. evaluate is called from
+        // every thread of jobs, at the same time for different groups.
+        template <typename EvaluateTransform>
+        void Update(JobSystem &jobs, EvaluateTransform &&evaluate)
+        {
+            std::atomic<size_t> evaluated = 0;
+            for (size_t level = 0; level + 1 < m_level_offsets.size(); ++level)
+            {
+                const size_t first = m_level_offsets[level];
+                jobs.ParallelFor(
+                    m_level_offsets[level + 1] - first,
+                    SCENE_JOB_GRAIN,
+                    [&](const size_t begin, const size_t end)
+                    {
+                        size_t range_evaluated = 0;
+                        for (size_t i = begin; i < end; ++i)
+                            range_evaluated += updateNode(m_level_nodes[first + i], evaluate);
+                        evaluated.fetch_add(range_evaluated, std::memory_order_relaxed);
+                    }
+                );
+            }
+            m_evaluated_transforms = evaluated.load(std::memory_order_relaxed);
+            m_full_update = false;
+
+            jobs.ParallelFor(
+                m_instance_nodes.size(),
+                SCENE_JOB_GRAIN,
+                [this](const size_t begin, const size_t end) { updateInstanceBounds(begin, end); }
+            );
+            refitSubtrees();
+        }
+
+        // Tests the world bounds of every instance against frustum, see IsInstanceVisible
+        void Cull(const Frustum &frustum, JobSystem &jobs);
+        // Like Cull, walking the bounds of the subtrees instead. A subtree outside of frustum is culled and one
+        // completely inside of it accepted, with all of their groups and instances, without testing them. The
+        // instances of the groups across its border are tested on their own.
+        void CullGroups(const Frustum &frustum, JobSystem &jobs);
+
+        size_t GetNodeCount() const { return m_parents.size(); }
+        world::WorldGroup &GetGroup(const size_t node) const { return *m_groups[node]; }
+        uint32_t GetParent(const size_t node) const { return m_parents[node]; }
+        uint32_t GetSubtreeEnd(const size_t node) const { return m_subtree_ends[node]; }
+        const Mat3x4f &GetWorldTransform(const size_t node) const { return m_world_transforms[node]; }
+        // World transform of the parent, the identity for the root
+        const Mat3x4f &GetParentTransform(const size_t node) const
+        {
+            return m_parents[node] == SCENE_NO_PARENT ? Mat3x4fIdentity : m_world_transforms[m_parents[node]];
+        }
+        bool IsSubtreeTimeDependent(const size_t node) const { return m_subtree_time_dependent[node]; }
+        const AABB &GetSubtreeBounds(const size_t node) const { return m_subtree_bounds[node]; }
+        // Nodes from the root down to node
+        std::vector<uint32_t> GetNodePath(size_t node) const;
+
+        size_t GetInstanceCount() const { return m_instance_nodes.size(); }
+        uint32_t GetInstanceNode(const size_t instance) const { return m_instance_nodes[instance]; }
+        const world::GroupModel &GetInstanceModel(const size_t instance) const { return *m_instance_models[instance]; }
+        uint32_t GetInstanceIndexCount(const size_t instance) const { return m_instance_index_counts[instance]; }
+        const AABB &GetInstanceBounds(const size_t instance) const { return m_instance_bounds[instance]; }
+        bool IsInstanceVisible(const size_t instance) const { return m_instance_visible[instance]; }
+        const Mat3x4f &GetInstanceTransform(const size_t instance) const
+        {
+            return m_world_transforms[m_instance_nodes[instance]];
+        }
+
+        size_t GetEvaluatedTransforms() const { return m_evaluated_transforms; }
+        size_t GetVisibleInstances() const { return m_visible_instances; }
+        size_t GetTestedNodes() const { return m_tested_nodes; }
+        size_t GetSkippedNodes() const { return m_skipped_nodes; }
+    };
+} // namespace engine
+
+#endif // CG_SOLAR_SYSTEM_SCENE_H
@@ -0,0 +1,156 @@
+#include "StreamBuffer.h"
+
+#define GL_SILENCE_DEPRECATION
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    // Nanoseconds of each wait for a fence, repeated until it is signaled
+    constexpr GLuint64 FENCE_WAIT_NS = 1000000;
+} // namespace
+
+namespace engine
+{
+    void StreamBuffer::Init()
+    {
+        m_persistent = GLEW_ARB_buffer_storage && GLEW_ARB_sync;
+        create();
+    }
+
+    void StreamBuffer::create()
+    {
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        if (m_persistent)
+        {
+            constexpr GLbitfield FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            const auto size = static_cast<GLsizeiptr>(m_region_size * STREAM_BUFFER_FRAMES);
+            glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, FLAGS);
+            m_mapped = static_cast<uint8_t *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, FLAGS));
+            if (m_mapped != nullptr)
+                return;
+
+            // The storage is immutable, so orphaning needs another buffer
+            std::cerr << "Failed to map the stream buffer, orphaning it every frame instead" << std::endl;
+            m_persistent = false;
+            glDeleteBuffers(1, &m_buffer);
+            glGenBuffers(1, &m_buffer);
+            glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        }
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_region_size), nullptr, GL_STREAM_DRAW);
+    }
+
+    void StreamBuffer::destroy()
+    {
+        // The draws already submitted keep the storage until they finish
+        for (auto &fence : m_fences)
+        {
+            if (fence != nullptr)
+                glDeleteSync(static_cast<GLsync>(fence));
+            fence = nullptr;
+        }
+        if (m_mapped != nullptr)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            m_mapped = nullptr;
+        }
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+
+    void StreamBuffer::BeginFrame()
+    {
+        m_offset = 0;
+        m_used = 0;
+        m_allocations = 0;
+        if (m_persistent)
+        {
+            m_region = (m_region + 1) % STREAM_BUFFER_FRAMES;
+            waitForRegion();
+            return;
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_region_size), nullptr, GL_STREAM_DRAW);
+    }
+
+    void StreamBuffer::waitForRegion()
+    {
+        const auto fence = static_cast<GLsync>(m_fences[m_region]);
+        if (fence == nullptr)
+            return;
+
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED)
+        {
+            // The GPU is STREAM_BUFFER_FRAMES frames behind
+            const auto wait_start = std::chrono::steady_clock::now();
+            while (result == GL_TIMEOUT_EXPIRED)
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_NS);
+            m_stats.stalls++;
+            m_stats.stall_ms +=
+                std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - wait_start).count();
+        }
+        if (result == GL_WAIT_FAILED)
+            std::cerr << "Failed to wait for the stream buffer fence" << std::endl;
+
+        glDeleteSync(fence);
+        m_fences[m_region] = nullptr;
+    }
+
+    void StreamBuffer::grow(const size_t size)
+    {
+        // What this frame wrote stays in the old buffer until the draws reading it finish
+        size_t region_size = m_region_size * 2;
+        while (region_size < size)
+            region_size *= 2;
+
+        destroy();
+        m_region_size = region_size;
+        create();
+        m_region = 0;
+        m_offset = 0;
+        m_stats.grows++;
+    }
+
+    StreamAllocation StreamBuffer::Upload(const void *data, const size_t size)
+    {
+        size_t offset = (m_offset + STREAM_BUFFER_ALIGNMENT - 1) & ~(STREAM_BUFFER_ALIGNMENT - 1);
+        if (offset + size > m_region_size)
+        {
+            grow(size);
+            offset = 0;
+        }
+
+        const size_t region_offset = m_persistent ? m_region * m_region_size : 0;
+        if (m_persistent)
+        {
+            std::memcpy(m_mapped + region_offset + offset, data, size);
+        }
+        else
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+        }
+        m_offset = offset + size;
+        m_used += size;
+        m_allocations++;
+        return {m_buffer, region_offset + offset};
+    }
+
+    void StreamBuffer::EndFrame()
+    {
+        if (m_persistent)
+            m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        m_stats.used_bytes = m_used;
+        m_stats.allocations = m_allocations;
+        m_stats.region_size = m_region_size;
+    }
+} // namespace engine
@@ -0,0 +1,74 @@
+#ifndef CG_SOLAR_SYSTEM_STREAM_BUFFER_H
+#define CG_SOLAR_SYSTEM_STREAM_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace engine
+{
+    // Frames the GPU may still be reading while the next one is written, each with a region of the buffer
+    constexpr size_t STREAM_BUFFER_FRAMES = 3;
+    // Bytes of each region at the start, doubled when a frame needs more
+    constexpr size_t STREAM_BUFFER_INITIAL_REGION_SIZE = 1 << 20;
+    // Of the offset of every allocation, enough for any vertex attribute
+    constexpr size_t STREAM_BUFFER_ALIGNMENT = 16;
+
+    // Part of the stream buffer holding data written this frame, to be read at offset of buffer
+    struct StreamAllocation
+    {
+        uint32_t buffer = 0;
+        size_t offset = 0;
+    };
+
+    struct StreamBufferStats
+    {
+        size_t used_bytes = 0; // by the allocations of the last frame
+        size_t allocations = 0; // of the last frame
+        size_t region_size = 0;
+        size_t stalls = 0; // frames that waited for the GPU to finish reading their region, since Init
+        float stall_ms = 0; // waited in them
+        size_t grows = 0; // since Init
+    };
+
+    // Ring buffer for the data every frame uploads, like the instance transforms and the debug lines. Each frame
+    // writes its own region of the buffer, and only waits for the GPU when it is still reading the region from
+    // STREAM_BUFFER_FRAMES frames ago.
+    // With ARB_buffer_storage the buffer stays mapped, persistent and coherent, and a fence at the end of each frame
+    // tells when its region is free again. Otherwise the buffer is orphaned at the start of each frame, so the driver
+    // hands out new storage instead of waiting, and written with glBufferSubData.
+    class StreamBuffer
+    {
+        uint32_t m_buffer = 0;
+        bool m_persistent = false;
+        uint8_t *m_mapped = nullptr; // the whole buffer when persistent
+        void *m_fences[STREAM_BUFFER_FRAMES] = {}; // GLsync of the last frame that used each region
+        size_t m_region = 0;
+        size_t m_region_size = STREAM_BUFFER_INITIAL_REGION_SIZE;
+        size_t m_offset = 0; // in the region, of the next allocation
+        size_t m_used = 0; // bytes of the allocations of this frame
+        size_t m_allocations = 0;
+        StreamBufferStats m_stats = {};
+
+        void create();
+        void destroy();
+        void waitForRegion();
+        // Replaces the buffer with one of larger regions, fitting size more bytes in this frame
+        void grow(size_t size);
+
+    public:
+        // Creates the buffer, persistently mapped when the GL can
+        void Init();
+        bool IsPersistent() const { return m_persistent; }
+
+        // Moves to the region of the next frame, waiting for the GPU to finish reading it
+        void BeginFrame();
+        // Copies size bytes of data to the region of this frame, to be read until its EndFrame
+        StreamAllocation Upload(const void *data, size_t size);
+        // Fences the draws of the frame
+        void EndFrame();
+
+        const StreamBufferStats &GetStats() const { return m_stats; }
+    };
+} // namespace engine
+
+#endif // CG_SOLAR_SYSTEM_STREAM_BUFFER_H
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <math.h>
 #include "Mat.h"
+#include "SinCos.h"
 
 namespace generator
 {
@@ -55,14 +56,23 @@ namespace generator
         const auto slice_size = 2 * M_PI / slices;
         const auto stack_size = M_PI / stacks;
 
+        // alpha from 0 to 2PI
+        // beta from -PI/2 to PI/2
+        std::vector<float> sin_alpha(slices + 1), cos_alpha(slices + 1);
+        std::vector<float> sin_beta(stacks + 1), cos_beta(stacks + 1);
+        SinCosRing(0, slice_size, sin_alpha, cos_alpha);
+        SinCosRing(-M_PI_2, stack_size, sin_beta, cos_beta);
+
         for (int slice = 0; slice <= slices; ++slice)
         {
             for (int stack = 0; stack <= stacks; ++stack)
             {
-                // alpha from 0 to 2PI
-                // beta from -PI/2 to PI/2
-                vertex.push_back(Vec3fSpherical(radius, slice * slice_size, stack * stack_size - M_PI_2));
-                normals.push_back(Vec3fSpherical(1, slice * slice_size, stack * stack_size - M_PI_2));
+                // Vec3fSpherical(1, alpha, beta)
+                const Vec3f normal = {
+                    cos_beta[stack] * sin_alpha[slice], sin_beta[stack], cos_beta[stack] * cos_alpha[slice]
+                };
+                vertex.push_back(normal * radius);
+                normals.push_back(normal);
                 tex_coords.push_back(Vec2f(slice * 1.0f / slices, stack * 1.0f / stacks));
             }
         }
@@ -109,19 +119,26 @@ namespace generator
         tex_coords.push_back(Vec2f{0.5, 0.5});
 
         const float cone_angle = atan(radius / height);
+        const float sin_cone_angle = sinf(cone_angle);
+        const float cos_cone_angle = cosf(cone_angle);
+
+        std::vector<float> sin_alpha(slices + 1), cos_alpha(slices + 1);
+        SinCosRing(0, slice_size, sin_alpha, cos_alpha);
 
         for (int slice = 0; slice <= slices; ++slice)
         {
-            vertex.push_back(Vec3fPolar(radius, slice * slice_size, 0)); // base vertice
+            const float sin = sin_alpha[slice];
+            const float cos = cos_alpha[slice];
+
+            vertex.push_back(Vec3f(radius * sin, 0, radius * cos)); // base vertice
             normals.push_back(Vec3f{0, -1, 0});
-            tex_coords.push_back(Vec2f(0.5, 0.5) + Vec2fPolar(0.5, slice * slice_size));
+            tex_coords.push_back(Vec2f(0.5, 0.5) + Vec2f(0.5f * cos, 0.5f * sin));
 
-            const float circle_angle = slice * slice_size;
-            Vec3f normal = Vec3fSpherical(1, circle_angle, cone_angle);
+            Vec3f normal = {cos_cone_angle * sin, sin_cone_angle, cos_cone_angle * cos};
             for (int stack = 0; stack <= stacks; ++stack)
             {
                 const float current_radius = radius - stack * radius / stacks;
-                vertex.push_back(Vec3fPolar(current_radius, slice * slice_size, stack * stack_size));
+                vertex.push_back(Vec3f(current_radius * sin, stack * stack_size, current_radius * cos));
                 normals.push_back(normal);
                 tex_coords.push_back(Vec2f(slice * 1.0f / slices, stack * 1.0f / stacks));
             }
@@ -162,35 +179,41 @@ namespace generator
         const auto plane = GeneratePlane(length, divisions);
         const auto vertex_size = plane.vertex.size();
 
-        std::vector<Mat4f> translations = {
-            Mat4fTranslate(0, length / 2, 0), // up
-            Mat4fTranslate(0, -length / 2, 0), // down
-            Mat4fTranslate(-length / 2, 0, 0), // left
-            Mat4fTranslate(length / 2, 0, 0), // right
-            Mat4fTranslate(0, 0, length / 2), // front
-            Mat4fTranslate(0, 0, -length / 2) // back
+        const Mat3x4f translations[] = {
+            Mat3x4fTranslate(0, length / 2, 0), // up
+            Mat3x4fTranslate(0, -length / 2, 0), // down
+            Mat3x4fTranslate(-length / 2, 0, 0), // left
+            Mat3x4fTranslate(length / 2, 0, 0), // right
+            Mat3x4fTranslate(0, 0, length / 2), // front
+            Mat3x4fTranslate(0, 0, -length / 2) // back
         };
 
-        std::vector<Mat4f> rotations = {
-            Mat4fIdentity, // up
-            Mat4fRotateX_M_PI, // down
-            Mat4fRotateZ_M_PI_2 * Mat4fRotateY_NEGATIVE_M_PI_2, // left
-            Mat4fRotateZ_NEGATIVE_M_PI_2 * Mat4fRotateY_M_PI_2, // right
-            Mat4fRotateX_M_PI_2, // front
-            Mat4fRotateX_NEGATIVE_M_PI_2 * Mat4fRotateY_M_PI // back
+        // Folded at compile time
+        constexpr Mat3x4f rotations[] = {
+            Mat3x4fIdentity, // up
+            Mat4fRotateX(M_PI).ToMat3x4f(), // down
+            (Mat4fRotateZ(M_PI_2) * Mat4fRotateY(-M_PI_2)).ToMat3x4f(), // left
+            (Mat4fRotateZ(-M_PI_2) * Mat4fRotateY(M_PI_2)).ToMat3x4f(), // right
+            Mat4fRotateX(M_PI_2).ToMat3x4f(), // front
+            (Mat4fRotateX(-M_PI_2) * Mat4fRotateY(M_PI)).ToMat3x4f() // back
         };
 
-        for (int i = 0; i < translations.size(); ++i)
-        {
-            for (auto &v : plane.vertex)
-            {
-                vertex.push_back((translations[i] * rotations[i] * v.ToVec4f()).ToVec3f());
-            }
+        constexpr size_t faces = std::size(translations);
+        vertex.resize(faces * vertex_size);
+        normals.resize(faces * plane.normals.size());
 
-            for (auto &n : plane.normals)
-            {
-                normals.push_back((rotations[i] * n.ToVec4f()).ToVec3f());
-            }
+        for (size_t i = 0; i < faces; ++i)
+        {
+            TransformPoints(
+                translations[i] * rotations[i],
+                plane.vertex,
+                std::span(vertex).subspan(i * vertex_size, vertex_size)
+            );
+            TransformDirections(
+                rotations[i],
+                plane.normals,
+                std::span(normals).subspan(i * plane.normals.size(), plane.normals.size())
+            );
 
             for (auto &t : plane.tex_coords)
             {
@@ -230,28 +253,36 @@ namespace generator
         const uint32_t base_middle = 0;
         const uint32_t up_middle = 1;
 
+        std::vector<float> sin_alpha(slices + 1), cos_alpha(slices + 1);
+        SinCosRing(0, alpha, sin_alpha, cos_alpha);
+
         for (int i = 0; i <= slices; i++)
         {
             const uint32_t current_index = vertex.size();
 
-            Vec3f bottom_vertice = Vec3fPolar(radius, static_cast<float>(i) * alpha);
+            const Vec3f side_normal = {sin_alpha[i], 0, cos_alpha[i]};
+            const Vec2f base_tex_coords_offset = {
+                BASE_RADIUS_TEX_COORDS * cos_alpha[i], BASE_RADIUS_TEX_COORDS * sin_alpha[i]
+            };
+
+            Vec3f bottom_vertice = side_normal * radius;
             Vec3f upper_vertice = bottom_vertice.with_y(height);
 
             vertex.push_back(bottom_vertice); // base
             normals.push_back(Vec3f(0, -1, 0));
-            tex_coords.push_back(BOTTOM_BASE_MIDDLE_TEX_COORDS + Vec2fPolar(BASE_RADIUS_TEX_COORDS, i * alpha));
+            tex_coords.push_back(BOTTOM_BASE_MIDDLE_TEX_COORDS + base_tex_coords_offset);
 
             vertex.push_back(bottom_vertice); // side
-            normals.push_back(Vec3fPolar(1, static_cast<float>(i) * alpha));
+            normals.push_back(side_normal);
             tex_coords.push_back(Vec2f(i * 1.0f / slices, SIDE_START_Y_TEX_COORDS));
 
             vertex.push_back(upper_vertice); // side
-            normals.push_back(Vec3fPolar(1, static_cast<float>(i) * alpha));
+            normals.push_back(side_normal);
             tex_coords.push_back(Vec2f(i * 1.0f / slices, 1.0f));
 
             vertex.push_back(upper_vertice); // top
             normals.push_back(Vec3f(0, 1, 0));
-            tex_coords.push_back(TOP_BASE_MIDDLE_TEX_COORDS + Vec2fPolar(BASE_RADIUS_TEX_COORDS, i * alpha));
+            tex_coords.push_back(TOP_BASE_MIDDLE_TEX_COORDS + base_tex_coords_offset);
 
             const uint32_t bottom_base_vertex_left = current_index;
             const uint32_t bottom_side_vertex_left = current_index + 1;
@@ -181,10 +181,20 @@ namespace generator::solarsystem
 
             const float planet_actual_translation_delta = log2sign(planet.orbital_period) * 5;
 
-            planetery_group.transformations.AddTransform(world::transform::TranslationThroughPoints(
+            // The mean distance is the semi-major axis, and the distances at the ends of the ellipse give the
+            // eccentricity. The orientation of the orbit isn't in the data, so it's random like the starting point.
+            const float eccentricity = (planet.aphelion - planet.perihelion) / (planet.aphelion + planet.perihelion);
+            const float ascending_node = randomRadians();
+            const float periapsis_argument = randomRadians();
+            const float mean_anomaly = randomRadians();
+            planetery_group.transformations.AddTransform(world::transform::KeplerOrbit(
                 planet_actual_translation_delta,
-                false,
-                generatePointsInCircle(distance, 10, degrees_to_radians(std::rand() % 360))
+                distance,
+                eccentricity,
+                degrees_to_radians(planet.orbital_inclination),
+                ascending_node,
+                periapsis_argument,
+                mean_anomaly
             ));
 
             planetery_group.transformations.AddTransform(
@@ -229,10 +239,14 @@ namespace generator::solarsystem
 
                 const auto random_distance_offset = fmod((double)rand() / (RAND_MAX), log2(moon_distance_to_planet));
 
-                moon_group.transformations.AddTransform(world::transform::TranslationThroughPoints(
+                moon_group.transformations.AddTransform(world::transform::KeplerOrbit(
                     planet_actual_translation_delta / 5 * 2,
-                    false,
-                    generatePointsInCircle(moon_distance_to_planet + random_distance_offset, 10, randomRadians())
+                    moon_distance_to_planet + random_distance_offset,
+                    0,
+                    0,
+                    0,
+                    0,
+                    randomRadians()
                 ));
                 moon_group.transformations.AddTransform(world::transform::Scale(Vec3f(std::max(0.1f, real_moon_diameter)
                 )));
@@ -294,7 +308,8 @@ namespace generator::solarsystem
         comet_group.transformations.AddTransform(world::transform::TranslationThroughPoints(
             60.0f,
             true,
-            generatePointsInElipsis(comet_distance_a_from_sun, comet_distance_b_from_sun, 10, randomRadians())
+            generatePointsInElipsis(comet_distance_a_from_sun, comet_distance_b_from_sun, 10, randomRadians()),
+            true
         ));
         comet_group.transformations.AddTransform(world::transform::Rotation(-M_PI_2, {1, 0, 0}));
         comet_group.transformations.AddTransform(world::transform::RotationWithTime(20.0f, {1, 0, 0}));